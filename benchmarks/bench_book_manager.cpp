@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include "lumina/book_manager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lumina;
+
+// Each shard thread churns add/cancel over its own symbols' books. Args are
+// {symbols, threads}; items/s is aggregate updates across all shards. The
+// shard threads start once; each iteration releases them for one round and
+// waits for all of them, and order ids keep rising across rounds so every
+// add rests and every cancel hits a resting order.
+static void BM_BookManager_ShardedUpdates(benchmark::State& state) {
+  const size_t n_symbols = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+  const uint32_t n_cores = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<uint32_t> cores;
+  for (size_t i = 0; i < n_threads; ++i) cores.push_back(static_cast<uint32_t>(i % n_cores));
+  BookManager mgr(cores, 1 << 12);
+  for (size_t i = 0; i < n_symbols; ++i) mgr.add_symbol("SYM" + std::to_string(i));
+  constexpr size_t ops_per_shard = 1 << 18;
+  std::atomic<uint64_t> round{0};
+  std::atomic<uint64_t> finished{0};
+  mgr.start([&](size_t shard) {
+    const auto& syms = mgr.shard_symbols(shard);
+    const OrderId window = syms.size() * 8;
+    OrderId id = 1;
+    for (uint64_t seen = 0;;) {
+      uint64_t r;
+      while ((r = round.load(std::memory_order_acquire)) == seen) {
+        if (!mgr.running()) return;
+        std::this_thread::yield();
+      }
+      seen = r;
+      for (size_t op = 0; !syms.empty() && op < ops_per_shard; op += 2, ++id) {
+        OrderBook& book = mgr.book(syms[id % syms.size()]);
+        benchmark::DoNotOptimize(
+            book.add_order(id, 10000 - static_cast<Price>(id % 64), 10, Side::Buy));
+        if (id > window) book.cancel_order(id - window);
+      }
+      finished.fetch_add(1, std::memory_order_release);
+    }
+  });
+  uint64_t rounds = 0;
+  for (auto _ : state) {
+    round.store(++rounds, std::memory_order_release);
+    while (finished.load(std::memory_order_acquire) < rounds * n_threads)
+      std::this_thread::yield();
+  }
+  mgr.stop();
+  state.SetItemsProcessed(state.iterations() * ops_per_shard * n_threads);
+}
+BENCHMARK(BM_BookManager_ShardedUpdates)
+  ->ArgsProduct({{16, 128, 512}, {1, 2, 4, 8}})
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
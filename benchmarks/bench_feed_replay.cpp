@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include "lumina/itch_feed.hpp"
+#include "lumina/market_data_handler.hpp"
+#include "lumina/risk_checks.hpp"
+#include "lumina/strategy_engine.hpp"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace lumina;
+
+constexpr size_t kMessages = 1 << 20;
+
+// Synthetic order flow around a drifting mid: mostly adds and cancels near
+// the touch, with executions, replaces and hidden trades mixed in. Written
+// once per process to a temp file, which every benchmark mmaps.
+static const std::string& capture_path() {
+  static const std::string path = [] {
+    std::string p = "/tmp/lumina_bench_itch_" + std::to_string(getpid()) + ".bin";
+    std::ofstream out(p, std::ios::binary);
+    ItchWriter w(out);
+    std::mt19937_64 rng(7);
+    std::vector<OrderId> live;
+    OrderId next_id = 1;
+    Price mid = 100000;
+    TimestampNs ts = 0;
+    for (size_t i = 0; i < kMessages; ++i) {
+      ts += 200 + rng() % 800;
+      if (rng() % 64 == 0) mid += static_cast<Price>(rng() % 3) - 1;
+      const unsigned roll = rng() % 100;
+      if (live.size() < 64 || roll < 45) {
+        const Side side = rng() % 2 ? Side::Buy : Side::Sell;
+        const Price offset = 1 + static_cast<Price>(rng() % 20);
+        const Price px = side == Side::Buy ? mid - offset : mid + offset;
+        w.add_order(ts, next_id, side, px, 100 + rng() % 400);
+        live.push_back(next_id++);
+        continue;
+      }
+      const size_t k = rng() % live.size();
+      const OrderId id = live[k];
+      if (roll < 70) {
+        w.delete_order(ts, id);
+        live[k] = live.back();
+        live.pop_back();
+      } else if (roll < 80) {
+        w.cancel_order(ts, id, 50);
+      } else if (roll < 90) {
+        w.execute_order(ts, id, 50);
+      } else if (roll < 95) {
+        w.replace_order(ts, id, next_id, mid + static_cast<Price>(rng() % 41) - 20, 200);
+        live[k] = next_id++;
+      } else {
+        w.trade(ts, rng() % 2 ? Side::Buy : Side::Sell, mid, 100);
+      }
+    }
+    std::atexit([] { std::remove(capture_path().c_str()); });
+    return p;
+  }();
+  return path;
+}
+
+static void BM_Itch_Decode(benchmark::State& state) {
+  std::vector<FeedMessage> batch(MAX_FEED_BATCH);
+  for (auto _ : state) {
+    ReplayFeedSource feed;
+    feed.open(capture_path());
+    while (!feed.finished()) benchmark::DoNotOptimize(feed.poll(batch.data(), batch.size()));
+  }
+  state.SetItemsProcessed(state.iterations() * kMessages);
+}
+BENCHMARK(BM_Itch_Decode)->Unit(benchmark::kMillisecond);
+
+// Whole pipeline on one thread: decode, book update and publish in the
+// handler, then the strategy drains the ring after every handler pass.
+static void BM_Replay_HandlerStrategy(benchmark::State& state) {
+  PreTradeRisk risk(INT64_MAX / 2, 1'000'000);
+  size_t quotes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ring = std::make_shared<MarketDataHandler::MDRing>();
+    auto handler = std::make_unique<MarketDataHandler>(ring);
+    StrategyEngine strategy(ring, 0.1, 0.02, 3600.0, risk);
+    strategy.set_order_callback([&](OrderId, Price, Qty, Side, bool) { ++quotes; });
+    ReplayFeedSource feed;
+    feed.open(capture_path());
+    handler->set_feed(&feed);
+    state.ResumeTiming();
+    while (!feed.finished()) {
+      handler->poll_feed();
+      strategy.poll();
+    }
+  }
+  benchmark::DoNotOptimize(quotes);
+  state.SetItemsProcessed(state.iterations() * kMessages);
+}
+BENCHMARK(BM_Replay_HandlerStrategy)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include "lumina/memory_pool.hpp"
+#include "lumina/types.hpp"
+#include <cstdlib>
+#include <memory>
+
+using namespace lumina;
+
+constexpr size_t kPoolBlocks = 1 << 16;
+constexpr int kBurst = 64;
+
+// Shared by all benchmark threads so the multi-threaded runs contend on it.
+static MemoryPool<Order, kPoolBlocks>& shared_pool() {
+  static auto pool = std::make_unique<MemoryPool<Order, kPoolBlocks>>();
+  return *pool;
+}
+
+static void BM_MemoryPool_AllocFree(benchmark::State& state) {
+  auto& pool = shared_pool();
+  for (auto _ : state) {
+    Order* o = pool.allocate();
+    benchmark::DoNotOptimize(o);
+    pool.deallocate(o);
+  }
+  pool.drain_local();
+}
+BENCHMARK(BM_MemoryPool_AllocFree)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_Malloc_AllocFree(benchmark::State& state) {
+  for (auto _ : state) {
+    void* o = std::malloc(sizeof(Order));
+    benchmark::DoNotOptimize(o);
+    std::free(o);
+  }
+}
+BENCHMARK(BM_Malloc_AllocFree)->ThreadRange(1, 8)->UseRealTime();
+
+// Bursts larger than a magazine, so the shared list is refilled from and
+// spilled to on every iteration.
+static void BM_MemoryPool_Burst(benchmark::State& state) {
+  auto& pool = shared_pool();
+  Order* held[kBurst];
+  for (auto _ : state) {
+    for (int i = 0; i < kBurst; ++i) held[i] = pool.allocate();
+    benchmark::DoNotOptimize(held);
+    for (int i = 0; i < kBurst; ++i) pool.deallocate(held[i]);
+  }
+  pool.drain_local();
+  state.SetItemsProcessed(state.iterations() * kBurst);
+}
+BENCHMARK(BM_MemoryPool_Burst)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_Malloc_Burst(benchmark::State& state) {
+  void* held[kBurst];
+  for (auto _ : state) {
+    for (int i = 0; i < kBurst; ++i) held[i] = std::malloc(sizeof(Order));
+    benchmark::DoNotOptimize(held);
+    for (int i = 0; i < kBurst; ++i) std::free(held[i]);
+  }
+  state.SetItemsProcessed(state.iterations() * kBurst);
+}
+BENCHMARK(BM_Malloc_Burst)->ThreadRange(1, 8)->UseRealTime();
+
+// Magazines disabled: every operation is a tagged CAS on the shared head.
+static void BM_MemoryPool_SharedOnly(benchmark::State& state) {
+  static auto pool = std::make_unique<MemoryPool<Order, kPoolBlocks, 0>>();
+  for (auto _ : state) {
+    Order* o = pool->allocate();
+    benchmark::DoNotOptimize(o);
+    pool->deallocate(o);
+  }
+}
+BENCHMARK(BM_MemoryPool_SharedOnly)->ThreadRange(1, 8)->UseRealTime();
@@ -1,5 +1,11 @@
 #include <benchmark/benchmark.h>
 #include "lumina/order_book.hpp"
+#include "lumina/mbp_book.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
 
 using namespace lumina;
 
@@ -7,7 +13,8 @@ static void BM_OrderBook_AddCancel(benchmark::State& state) {
   OrderBook book(1 << 18);
   OrderId id = 0;
   for (auto _ : state) {
-    book.add_order(++id, 10000 + (id % 100), 10, Side::Buy);
+    ++id;
+    book.add_order(id, 10000 + (id % 100), 10, Side::Buy);
     if (id % 2 == 0)
       book.cancel_order(id - 1);
   }
@@ -24,3 +31,131 @@ static void BM_OrderBook_MidPrice(benchmark::State& state) {
     benchmark::DoNotOptimize(book.mid_price());
 }
 BENCHMARK(BM_OrderBook_MidPrice)->Iterations(1000000);
+
+// Improve the bid by one tick and cancel it again: the cancel empties the
+// touch and forces a best-price search. Cost should be flat in book depth.
+static void BM_OrderBook_CancelAtTouch(benchmark::State& state) {
+  const int depth = static_cast<int>(state.range(0));
+  OrderBook book(1 << 18, 1 << 14);
+  for (int i = 0; i < depth; ++i)
+    book.add_order(i + 1, 100000 - i, 10, Side::Buy);
+  OrderId id = 1 << 20;
+  for (auto _ : state) {
+    book.add_order(++id, 100001, 10, Side::Buy);
+    book.cancel_order(id);
+    benchmark::DoNotOptimize(book.best_bid());
+  }
+}
+BENCHMARK(BM_OrderBook_CancelAtTouch)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+namespace {
+
+/// The order_index_ access pattern OrderBook used before OrderIdMap.
+struct StdOrderIndex {
+  explicit StdOrderIndex(size_t n) { map.reserve(n); }
+  bool insert(OrderId id, OrderNodePool::Node* n) {
+    if (map.count(id)) return false;
+    map[id] = n;
+    return true;
+  }
+  OrderNodePool::Node* find(OrderId id) const {
+    auto it = map.find(id);
+    return it == map.end() ? nullptr : it->second;
+  }
+  OrderNodePool::Node* erase(OrderId id) {
+    auto it = map.find(id);
+    if (it == map.end()) return nullptr;
+    OrderNodePool::Node* n = it->second;
+    map.erase(it);
+    return n;
+  }
+  std::unordered_map<OrderId, OrderNodePool::Node*> map;
+};
+
+using FlatOrderIndex = OrderIdMap<OrderNodePool::Node*>;
+
+constexpr size_t RESTING_ORDERS = 1 << 20;
+
+void report_percentiles(benchmark::State& state, std::vector<int64_t>& ns) {
+  if (ns.empty()) return;
+  auto pct = [&](double p) {
+    auto it = ns.begin() + static_cast<std::ptrdiff_t>(p * (ns.size() - 1));
+    std::nth_element(ns.begin(), it, ns.end());
+    return static_cast<double>(*it);
+  };
+  state.counters["p50_ns"] = pct(0.50);
+  state.counters["p99_ns"] = pct(0.99);
+  state.counters["p999_ns"] = pct(0.999);
+}
+
+} // namespace
+
+// Index churn at 1M resting orders: each iteration cancels the oldest id,
+// adds a new one and modifies (looks up and updates) a random live one.
+// Every operation is timed individually to report tail latency.
+template <typename Index>
+static void BM_OrderIndex_Churn1M(benchmark::State& state) {
+  Index index(RESTING_ORDERS + 1);
+  std::vector<OrderNodePool::Node> nodes(RESTING_ORDERS + 1);
+  for (OrderId id = 0; id < RESTING_ORDERS; ++id)
+    index.insert(id, &nodes[id]);
+  std::vector<int64_t> ns;
+  ns.reserve(static_cast<size_t>(state.max_iterations) * 3);
+  std::mt19937_64 gen(7);
+  OrderId oldest = 0, next = RESTING_ORDERS;
+  auto timed = [&](auto&& op) {
+    auto t0 = std::chrono::steady_clock::now();
+    op();
+    auto t1 = std::chrono::steady_clock::now();
+    ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+  };
+  for (auto _ : state) {
+    timed([&] { benchmark::DoNotOptimize(index.erase(oldest++)); });
+    timed([&] { benchmark::DoNotOptimize(index.insert(next, &nodes[next % nodes.size()])); });
+    ++next;
+    const OrderId target = oldest + gen() % RESTING_ORDERS;
+    timed([&] {
+      OrderNodePool::Node* n = index.find(target);
+      if (n) n->order.qty += 1;
+      benchmark::DoNotOptimize(n);
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * 3);
+  report_percentiles(state, ns);
+}
+BENCHMARK_TEMPLATE(BM_OrderIndex_Churn1M, StdOrderIndex)->Iterations(1000000);
+BENCHMARK_TEMPLATE(BM_OrderIndex_Churn1M, FlatOrderIndex)->Iterations(1000000);
+
+// Whole-book add/cancel throughput with 1M resting orders spread over the
+// ladder window.
+static void BM_OrderBook_Churn1M(benchmark::State& state) {
+  OrderBook book(RESTING_ORDERS + 1);
+  for (OrderId id = 0; id < RESTING_ORDERS; ++id)
+    book.add_order(id + 1, 100000 - static_cast<Price>(id % 1000), 10, Side::Buy);
+  OrderId oldest = 1, next = RESTING_ORDERS + 1;
+  for (auto _ : state) {
+    book.cancel_order(oldest++);
+    book.add_order(next, 100000 - static_cast<Price>(next % 1000), 10, Side::Buy);
+    ++next;
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_OrderBook_Churn1M)->Iterations(1000000);
+
+// Price-level feed update on the market-by-price book: no order nodes or
+// order-id index on the path.
+static void BM_MbpBook_LevelUpdates(benchmark::State& state) {
+  MbpBook book;
+  for (int i = 0; i < 100; ++i) {
+    book.set_level(Side::Buy, 10000 - i, 100, 4);
+    book.set_level(Side::Sell, 10001 + i, 100, 4);
+  }
+  int64_t n = 0;
+  for (auto _ : state) {
+    const Price px = 10000 - (n % 100);
+    book.set_level(Side::Buy, px, 50 + (n & 63), 3);
+    ++n;
+    benchmark::DoNotOptimize(book.depth_qty(Side::Buy));
+  }
+}
+BENCHMARK(BM_MbpBook_LevelUpdates)->Iterations(1000000);
@@ -1,16 +1,185 @@
 #include <benchmark/benchmark.h>
 #include "lumina/ring_buffer.hpp"
+#include "lumina/multicast_ring.hpp"
 #include "lumina/types.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 
 using namespace lumina;
 
 static void BM_SPSC_PushPop(benchmark::State& state) {
   SPSCRingBuffer<MarketDataEvent, 65536> rb;
   MarketDataEvent e{};
-  e.mid = 10000;
+  e.bid = 10000;
   for (auto _ : state) {
     rb.try_push(e);
     rb.try_pop(e);
   }
 }
 BENCHMARK(BM_SPSC_PushPop)->Iterations(1000000);
+
+using EventRing = SPSCRingBuffer<MarketDataEvent, 65536>;
+
+// Producer (benchmark thread) and consumer on separate threads; one
+// iteration moves range(0) events. Batch 1 goes through try_push/try_pop,
+// larger batches through try_push_n/try_pop_n.
+static void BM_SPSC_CrossThread(benchmark::State& state) {
+  const size_t batch = static_cast<size_t>(state.range(0));
+  auto rb = std::make_unique<EventRing>();
+  std::atomic<bool> done{false};
+  std::thread consumer([&] {
+    std::vector<MarketDataEvent> out(batch);
+    for (;;) {
+      const bool stop = done.load(std::memory_order_acquire);
+      const size_t n = batch == 1 ? rb->try_pop(out[0]) : rb->try_pop_n(out.data(), batch);
+      if (n == 0 && stop) break;
+      benchmark::DoNotOptimize(out.data());
+    }
+  });
+  std::vector<MarketDataEvent> in(batch);
+  for (size_t i = 0; i < batch; ++i) in[i].bid = static_cast<Price>(i);
+  for (auto _ : state) {
+    for (size_t sent = 0; sent < batch;)
+      sent += batch == 1 ? rb->try_push(in[0]) : rb->try_push_n(in.data() + sent, batch - sent);
+  }
+  done.store(true, std::memory_order_release);
+  consumer.join();
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(batch));
+}
+BENCHMARK(BM_SPSC_CrossThread)->Arg(1)->Arg(8)->Arg(32)->Arg(128)->UseRealTime();
+
+// Same traffic through claim/commit and peek/release, filling and reading
+// each slot in place instead of copying a staging buffer.
+static void BM_SPSC_CrossThreadInPlace(benchmark::State& state) {
+  auto rb = std::make_unique<EventRing>();
+  std::atomic<bool> done{false};
+  std::thread consumer([&] {
+    Price sum = 0;
+    for (;;) {
+      const bool stop = done.load(std::memory_order_acquire);
+      const MarketDataEvent* ev = rb->peek();
+      if (!ev) {
+        if (stop) break;
+        continue;
+      }
+      sum += ev->bid;
+      rb->release();
+    }
+    benchmark::DoNotOptimize(sum);
+  });
+  Price i = 0;
+  for (auto _ : state) {
+    MarketDataEvent* slot;
+    while (!(slot = rb->claim())) {}
+    slot->bid = ++i;
+    rb->commit();
+  }
+  done.store(true, std::memory_order_release);
+  consumer.join();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SPSC_CrossThreadInPlace)->UseRealTime();
+
+// range(0) producers fan into range(1) consumers through one MPMC queue; each
+// iteration moves kMpmcItems items end to end (thread start-up included).
+constexpr uint64_t kMpmcItems = 1 << 16;
+
+template <typename Wait>
+static void BM_MPMC_Throughput(benchmark::State& state) {
+  const int producers = static_cast<int>(state.range(0));
+  const int consumers = static_cast<int>(state.range(1));
+  auto q = std::make_unique<MPMCRingBuffer<uint64_t, 4096, Wait>>();
+  for (auto _ : state) {
+    std::atomic<uint64_t> claimed{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+      threads.emplace_back([&] {
+        uint64_t v, sum = 0;
+        while (claimed.fetch_add(1, std::memory_order_relaxed) < kMpmcItems) {
+          q->pop(v);
+          sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+      });
+    }
+    for (int p = 0; p < producers; ++p) {
+      threads.emplace_back([&, p] {
+        const uint64_t n = kMpmcItems / producers + (p < static_cast<int>(kMpmcItems % producers));
+        for (uint64_t i = 0; i < n; ++i) q->push(i);
+      });
+    }
+    for (auto& t : threads) t.join();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kMpmcItems));
+}
+BENCHMARK_TEMPLATE(BM_MPMC_Throughput, SpinYieldWait)
+    ->ArgsProduct({{1, 2, 4, 8}, {1, 2, 4, 8}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MPMC_Throughput, BusySpinWait)
+    ->ArgsProduct({{1, 4, 8}, {1}})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MPMC_Throughput, FutexWait)
+    ->ArgsProduct({{1, 4, 8}, {1, 4}})->UseRealTime();
+
+// One producer, range(0) consumers on their own threads. Multicast writes
+// each event once; the copy variant pushes it into one SPSC ring per
+// consumer, which is what the handler would otherwise have to do.
+constexpr uint64_t kFanOutEvents = 1 << 16;
+
+static void BM_Multicast_FanOut(benchmark::State& state) {
+  const int consumers = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto ring = std::make_unique<MulticastRing<MarketDataEvent, 4096>>();
+    for (int c = 0; c < consumers; ++c) ring->add_consumer();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+      threads.emplace_back([&, c] {
+        Price sum = 0;
+        for (uint64_t seen = 0; seen < kFanOutEvents;)
+          seen += ring->poll(c, [&](const MarketDataEvent& ev) { sum += ev.bid; }, 64);
+        benchmark::DoNotOptimize(sum);
+      });
+    }
+    for (uint64_t i = 0; i < kFanOutEvents;) {
+      if (MarketDataEvent* slot = ring->claim()) {
+        slot->bid = static_cast<Price>(i++);
+        ring->publish();
+      }
+    }
+    for (auto& t : threads) t.join();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kFanOutEvents));
+}
+BENCHMARK(BM_Multicast_FanOut)->Arg(1)->Arg(2)->Arg(3)->UseRealTime();
+
+static void BM_SPSC_CopyFanOut(benchmark::State& state) {
+  const int consumers = static_cast<int>(state.range(0));
+  using Ring = SPSCRingBuffer<MarketDataEvent, 4096>;
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<Ring>> rings;
+    for (int c = 0; c < consumers; ++c) rings.push_back(std::make_unique<Ring>());
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+      threads.emplace_back([&, c] {
+        Price sum = 0;
+        for (uint64_t seen = 0; seen < kFanOutEvents;) {
+          if (const MarketDataEvent* ev = rings[c]->peek()) {
+            sum += ev->bid;
+            rings[c]->release();
+            ++seen;
+          }
+        }
+        benchmark::DoNotOptimize(sum);
+      });
+    }
+    MarketDataEvent ev{};
+    for (uint64_t i = 0; i < kFanOutEvents; ++i) {
+      ev.bid = static_cast<Price>(i);
+      for (auto& rb : rings)
+        while (!rb->try_push(ev)) {}
+    }
+    for (auto& t : threads) t.join();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kFanOutEvents));
+}
+BENCHMARK(BM_SPSC_CopyFanOut)->Arg(1)->Arg(2)->Arg(3)->UseRealTime();
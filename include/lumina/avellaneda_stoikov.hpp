@@ -26,12 +26,20 @@ public:
     return (1.0 / k) * std::log(1.0 + gamma_ / k);
   }
 
+  /// Inventory-risk half of the AS spread term gamma * sigma^2 * (T - t):
+  /// widens the quotes with volatility and time left.
+  double risk_half_spread(double t) const {
+    double tau = T_ - t;
+    if (tau <= 0) return 0.0;
+    return 0.5 * gamma_ * sigma_ * sigma_ * tau;
+  }
+
   /// Bid/ask around reservation price with optional OBI skew.
   void get_quotes(double s, double t, double q, double k,
                    double obi_skew,  // -1 to +1: negative = more bids, positive = more asks
                    double& bid_offset, double& ask_offset) const {
     double r = reservation_price(s, t, q);
-    double half = optimal_half_spread(k);
+    double half = optimal_half_spread(k) + risk_half_spread(t);
     // OBI: if bid side has more volume, expect upward move -> skew quotes up
     double skew = obi_skew * 0.5 * half;  // configurable weight
     bid_offset = r - half - skew;
@@ -39,8 +47,10 @@ public:
   }
 
   void set_sigma(double sigma) { sigma_ = sigma; }
+  double sigma() const { return sigma_; }
   void set_gamma(double gamma) { gamma_ = gamma; }
   void set_T(double T_seconds) { T_ = T_seconds; }
+  double T() const { return T_; }
 
 private:
   double gamma_;
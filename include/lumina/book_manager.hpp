@@ -0,0 +1,101 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/order_book.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lumina {
+
+constexpr size_t SYMBOL_LEN = 16;  // matches TickRecord::symbol
+
+/// Interns symbol strings to dense SymbolIds (0, 1, 2, ...). Interning is a
+/// startup operation; find() takes a string_view and does not allocate.
+class SymbolTable {
+public:
+  SymbolId intern(std::string_view symbol);
+  SymbolId find(std::string_view symbol) const;
+  std::string_view name(SymbolId id) const;
+  size_t size() const { return names_.size(); }
+
+private:
+  struct Hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+  };
+  std::unordered_map<std::string, SymbolId, Hash, std::equal_to<>> ids_;
+  std::vector<std::string> names_;
+};
+
+/// Owns one pooled OrderBook per symbol and assigns symbols to shards, each
+/// served by one thread pinned to its own core. A shard thread only ever
+/// touches the books of its own symbols, so books are never shared across
+/// cores. Symbols are assigned round-robin in registration order. Books are
+/// constructed on their shard's pinned thread, so first touch places their
+/// pools, ladders and id tables on that core's NUMA node.
+class BookManager {
+public:
+  using ShardFn = std::function<void(size_t shard)>;
+
+  /// One shard per entry of shard_cores; books are sized by max_orders_per_book.
+  explicit BookManager(std::vector<uint32_t> shard_cores,
+                       size_t max_orders_per_book = 1 << 16);
+  ~BookManager();
+
+  /// Register a symbol (idempotent); its book is built by the next
+  /// build() or start(). Not thread-safe: call before start().
+  SymbolId add_symbol(std::string_view symbol);
+  SymbolId add_symbol(std::string_view symbol, size_t max_orders);
+
+  /// Construct every registered book not yet built, each on a thread pinned
+  /// to its shard's core, and wait for them. Call before touching books
+  /// outside the shard threads (e.g. loading snapshots); start() builds
+  /// any that are still missing.
+  void build();
+
+  const SymbolTable& symbols() const { return symbols_; }
+  OrderBook& book(SymbolId id) { return *books_[id]; }
+  const OrderBook& book(SymbolId id) const { return *books_[id]; }
+  size_t book_count() const { return books_.size(); }
+
+  size_t shard_count() const { return shards_.size(); }
+  size_t shard_of(SymbolId id) const { return shard_of_[id]; }
+  uint32_t shard_core(size_t shard) const { return shards_[shard].core; }
+  const std::vector<SymbolId>& shard_symbols(size_t shard) const {
+    return shards_[shard].symbols;
+  }
+
+  /// Spawn one thread per shard, pin it to its core, build its missing
+  /// books and run fn(shard).
+  /// fn should loop while running() and return once stop() is called.
+  void start(ShardFn fn);
+  void stop();
+  bool running() const { return running_.load(std::memory_order_acquire); }
+
+private:
+  struct alignas(64) Shard {
+    uint32_t core{0};
+    std::vector<SymbolId> symbols;
+    std::thread thread;
+  };
+
+  void build_shard(size_t shard);
+
+  SymbolTable symbols_;
+  std::vector<std::unique_ptr<OrderBook>> books_;  // null until built
+  std::vector<size_t> max_orders_;
+  std::vector<uint32_t> shard_of_;
+  std::vector<Shard> shards_;
+  size_t max_orders_per_book_;
+  std::atomic<bool> running_{false};
+};
+
+} // namespace lumina
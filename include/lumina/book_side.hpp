@@ -0,0 +1,101 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/memory_pool.hpp"
+#include "lumina/price_ladder.hpp"
+#include <concepts>
+#include <cstddef>
+
+namespace lumina {
+
+/// Price level: doubly-linked list of orders for time priority.
+/// prev/next link the side's levels in price order (prev = better).
+/// Market-by-price books leave head/tail null and set total_qty/count.
+struct PriceLevel {
+  Price price{0};
+  Qty total_qty{0};
+  int count{0};
+  OrderNodePool::Node* head{nullptr};
+  OrderNodePool::Node* tail{nullptr};
+  PriceLevel* prev{nullptr};
+  PriceLevel* next{nullptr};
+};
+
+constexpr size_t DEFAULT_DEPTH_LEVELS = 10;
+constexpr size_t DEFAULT_MAX_LEVELS = 4096;
+
+/// True if price a is strictly better than b on the given side.
+inline bool better_price(Side side, Price a, Price b) {
+  return side == Side::Buy ? a > b : a < b;
+}
+
+/// Level bookkeeping shared by the order-level and price-level books: the
+/// tick ladder, the best-to-worst level links, the best pointer and the
+/// running side volume / top-N depth. Levels come from a pool owned by the
+/// book so both sides share it.
+class BookSide {
+public:
+  BookSide(Side side, ChunkedPool<PriceLevel>& pool, size_t ladder_ticks,
+           size_t depth_levels);
+
+  PriceLevel* find(Price price) const { return ladder_.find(price); }
+  /// Existing level at price, or a new empty one spliced into place.
+  /// nullptr if the level pool is exhausted.
+  PriceLevel* get_or_create(Price price);
+  /// Bulk-load path: new empty level linked directly after worst, which
+  /// must be the current worst level (nullptr on an empty side). Skips the
+  /// ladder neighbour search. nullptr if the level pool is exhausted.
+  PriceLevel* append(Price price, PriceLevel* worst);
+  /// Unlink, drop from the ladder and return to the pool.
+  void remove(PriceLevel* level);
+
+  void apply_qty(PriceLevel* level, Qty delta) {
+    level->total_qty += delta;
+    volume_ += delta;
+    if (top_edge_ && !better_price(side_, top_edge_->price, level->price))
+      top_qty_ += delta;
+  }
+
+  Side side() const { return side_; }
+  PriceLevel* best() const { return best_; }
+  Qty volume() const { return volume_; }
+  Qty top_qty() const { return top_qty_; }
+  size_t depth_levels() const { return depth_levels_; }
+  size_t level_count() const { return ladder_.size(); }
+
+  /// Copy up to n levels best-first into SoA buffers; returns levels written.
+  size_t copy(size_t n, Price* price, Qty* qty, int* count) const;
+
+private:
+  void on_level_added(PriceLevel* level);
+  void on_level_removed(PriceLevel* level);
+
+  Side side_;
+  ChunkedPool<PriceLevel>& pool_;
+  PriceLadder ladder_;
+  PriceLevel* best_{nullptr};
+  Qty volume_{0};                  // all levels
+  Qty top_qty_{0};                 // best depth_levels_ levels
+  size_t top_levels_{0};           // levels counted in top_qty_
+  PriceLevel* top_edge_{nullptr};  // worst level counted in top_qty_
+  size_t depth_levels_;
+};
+
+/// Read API shared by OrderBook and MbpBook, so consumers such as
+/// MarketDataHandler can be built on either.
+template <typename B>
+concept DepthBook = requires(const B& b, Side side, Qty& q, DepthSnapshot<1>& snap) {
+  { b.best_bid() } -> std::same_as<Price>;
+  { b.best_ask() } -> std::same_as<Price>;
+  { b.mid_price() } -> std::same_as<Price>;
+  { b.bid_volume() } -> std::same_as<Qty>;
+  { b.ask_volume() } -> std::same_as<Qty>;
+  { b.best_bid_level() } -> std::same_as<BookLevel>;
+  { b.best_ask_level() } -> std::same_as<BookLevel>;
+  { b.depth_qty(side) } -> std::same_as<Qty>;
+  { b.level_qty(side, Price{}) } -> std::same_as<Qty>;
+  b.get_bid_ask_volumes(q, q);
+  b.snapshot_depth(size_t{1}, snap);
+};
+
+} // namespace lumina
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include <cstdint>
+
+namespace lumina {
+
+/// On-disk layout of an OrderBook checkpoint (native endianness):
+///   SnapshotHeader
+///   for bids then asks, levels best-first:
+///     SnapshotLevel, then SnapshotLevel::order_count x SnapshotOrder (FIFO)
+/// Price and side are stored once per level, so each order costs 32 bytes.
+/// Bump SNAPSHOT_VERSION on any layout change; older files are rejected.
+constexpr char SNAPSHOT_MAGIC[4] = {'L', 'O', 'B', 'K'};
+constexpr uint16_t SNAPSHOT_VERSION = 2;
+
+struct SnapshotHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t reserved;
+  uint64_t seq;          // feed sequence number the book state reflects
+  uint64_t order_count;
+  uint64_t bid_levels;
+  uint64_t ask_levels;
+};
+
+struct SnapshotLevel {
+  Price price;
+  uint32_t order_count;
+  uint32_t reserved;
+};
+
+constexpr uint32_t SNAPSHOT_POST_ONLY = 1;  // SnapshotOrder::flags
+
+struct SnapshotOrder {
+  OrderId id;
+  Qty qty;
+  TimestampNs created_ns;
+  uint32_t flags;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 40);
+static_assert(sizeof(SnapshotLevel) == 16);
+static_assert(sizeof(SnapshotOrder) == 32);
+
+} // namespace lumina
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/wait_strategy.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace lumina {
+
+/// Single-slot overflow for book events while the strategy lags. The
+/// handler parks a BookUpdate here instead of queueing it behind a
+/// backlog; each park replaces the previous one, so the slot always holds
+/// the freshest book state. The strategy takes it once it has drained the
+/// ring. Same seqlock scheme as TopOfBookCell: the event is copied as
+/// relaxed atomic words and the counter (two increments per park) doubles
+/// as the park count, from which take() derives how many events were
+/// merged away.
+class alignas(64) ConflationSlot {
+  static_assert(std::is_trivially_copyable_v<MarketDataEvent>);
+  static constexpr size_t WORDS = (sizeof(MarketDataEvent) + 7) / 8;
+
+public:
+  /// Writer (handler) thread only.
+  void park(const MarketDataEvent& ev) {
+    uint64_t words[WORDS]{};
+    std::memcpy(words, &ev, sizeof(ev));
+    const uint64_t v = version_.load(std::memory_order_relaxed);
+    version_.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; ++i) words_[i].store(words[i], std::memory_order_relaxed);
+    version_.store(v + 2, std::memory_order_release);
+  }
+
+  /// Reader (strategy) thread only. Copies the parked event if it has not
+  /// been taken yet and sets out.conflated to the number of events parked
+  /// before it since the last take (replaced without being seen).
+  bool take(MarketDataEvent& out) {
+    uint64_t words[WORDS];
+    for (;;) {
+      const uint64_t v = version_.load(std::memory_order_acquire);
+      if (v == taken_) return false;
+      if (v & 1) {
+        cpu_relax();
+        continue;
+      }
+      for (size_t i = 0; i < WORDS; ++i) words[i] = words_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version_.load(std::memory_order_relaxed) != v) continue;
+      std::memcpy(&out, words, sizeof(out));
+      out.conflated = static_cast<uint32_t>((v - taken_) / 2 - 1);
+      taken_ = v;
+      return true;
+    }
+  }
+
+  /// Events parked so far.
+  uint64_t parked() const { return version_.load(std::memory_order_acquire) / 2; }
+
+private:
+  std::atomic<uint64_t> version_{0};  // odd while a park is in flight
+  std::atomic<uint64_t> words_[WORDS]{};
+  alignas(64) uint64_t taken_{0};     // reader side: version last taken
+};
+
+} // namespace lumina
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace lumina {
+
+/// Kind of a normalised feed message. The order-level kinds follow an
+/// ITCH-style order feed keyed by order id; LevelDelta is a price-level
+/// (market-by-price) change.
+enum class FeedMsgType : uint8_t {
+  AddOrder,      // id, side, price, qty
+  CancelOrder,   // id, qty taken off (partial cancel)
+  DeleteOrder,   // id
+  ExecuteOrder,  // id, qty executed against the resting order
+  ReplaceOrder,  // id replaced by new_id at price/qty (loses priority)
+  Trade,         // trade against a non-displayed order: price, qty
+  LevelDelta,    // side, price, qty change at that level (negative removes)
+};
+
+/// One decoded update. Fields a kind does not use are left zero.
+struct FeedMessage {
+  FeedMsgType type{FeedMsgType::AddOrder};
+  Side side{Side::Buy};
+  OrderId id{0};
+  OrderId new_id{0};
+  Price price{0};
+  Qty qty{0};
+  uint64_t seq{0};  // feed sequence number
+  TimestampNs ts_ns{0};
+};
+
+/// Where MarketDataHandler's event loop gets its input (file replay,
+/// network feed, simulator). poll() is only ever called from the handler
+/// thread and should not block: it decodes whatever is ready, up to max
+/// messages, and returns 0 when there is nothing, so the loop can idle.
+class FeedSource {
+public:
+  virtual ~FeedSource() = default;
+
+  virtual size_t poll(FeedMessage* out, size_t max) = 0;
+  /// No more messages will ever arrive (end of a replay). Live feeds never
+  /// finish.
+  virtual bool finished() const { return false; }
+};
+
+} // namespace lumina
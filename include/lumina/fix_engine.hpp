@@ -1,8 +1,11 @@
 #pragma once
 
 #include "lumina/types.hpp"
+#include "lumina/scratch_arena.hpp"
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -41,6 +44,14 @@ public:
   /// Build OrderCancelRequest.
   std::string build_cancel_request(OrderId cl_ord_id, OrderId orig_cl_ord_id);
 
+  /// Same messages built into the event's scratch arena without touching
+  /// the heap; the views are valid until the arena is reset.
+  std::string_view build_new_order_single(ScratchArena& out, OrderId cl_ord_id,
+                                          std::string_view symbol, Side side, Qty qty,
+                                          Price price);
+  std::string_view build_cancel_request(ScratchArena& out, OrderId cl_ord_id,
+                                        OrderId orig_cl_ord_id);
+
 private:
   std::unordered_map<int, std::string> parse_tags(const char* msg, size_t len);
   FixCallback order_callback_;
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace lumina {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+constexpr int NUMA_ANY = -1;    // no binding
+constexpr int NUMA_LOCAL = -2;  // node of the CPU the constructing thread runs on
+
+/// How an arena's memory ended up being backed.
+enum class PageBacking : uint8_t {
+  HugeTlb,          // MAP_HUGETLB from the reserved hugepage pool
+  TransparentHuge,  // normal mapping with MADV_HUGEPAGE
+  Normal,           // 4K pages (hugepages disabled or refused)
+};
+
+struct ArenaOptions {
+  bool huge_pages{true};     // try MAP_HUGETLB, then MADV_HUGEPAGE
+  bool prefault{true};       // touch every page now instead of mid-session
+  int numa_node{NUMA_ANY};   // node id, NUMA_ANY or NUMA_LOCAL
+};
+
+/// Startup-time bump allocator over one mmap'd region, for the large hot
+/// structures (order nodes, level chunks, id index, rings, tick store).
+/// Memory is hugepage-backed when the system allows, optionally bound to a
+/// NUMA node and prefaulted, so the session never takes a first-touch page
+/// fault or a 4K TLB miss on it. Construct it on the thread that will own
+/// the data, after pin_thread_to_core, when using NUMA_LOCAL.
+///
+/// Not thread-safe. Individual allocations are never freed; the whole
+/// region goes back to the kernel when the arena is destroyed, so it must
+/// outlive everything allocated from it.
+class HugeArena {
+public:
+  explicit HugeArena(size_t bytes, ArenaOptions options = {});
+  ~HugeArena();
+  HugeArena(const HugeArena&) = delete;
+  HugeArena& operator=(const HugeArena&) = delete;
+
+  /// nullptr if the arena cannot fit bytes at align.
+  void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+  /// Construct a T in the arena (e.g. a ring or pool with inline storage).
+  /// The caller destroys it (see arena_shared) before the arena goes away.
+  template <typename T, typename... Args>
+  T* create(Args&&... args) {
+    void* p = allocate(sizeof(T), alignof(T));
+    return p ? new (p) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  bool owns(const void* p) const {
+    auto* c = static_cast<const char*>(p);
+    return c >= base_ && c < base_ + capacity_;
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t used() const { return used_; }
+  PageBacking backing() const { return backing_; }
+  /// Node the memory is bound to, or NUMA_ANY if unbound.
+  int numa_node() const { return numa_node_; }
+
+private:
+  char* base_{nullptr};
+  size_t capacity_{0};
+  size_t used_{0};
+  PageBacking backing_{PageBacking::Normal};
+  int numa_node_{NUMA_ANY};
+};
+
+/// NUMA node of the CPU the calling thread is running on (0 if unknown).
+int current_numa_node();
+
+/// Construct a T in the arena owned by a shared_ptr that runs ~T but leaves
+/// the memory to the arena. Falls back to the heap if the arena is full.
+template <typename T, typename... Args>
+std::shared_ptr<T> arena_shared(HugeArena& arena, Args&&... args) {
+  if (T* p = arena.create<T>(std::forward<Args>(args)...))
+    return std::shared_ptr<T>(p, [](T* q) { q->~T(); });
+  return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+/// Standard allocator drawing from a HugeArena, or from the heap when the
+/// arena is null or full. Deallocation inside the arena is a no-op, so use
+/// it for containers sized once at startup.
+template <typename T>
+struct ArenaAllocator {
+  using value_type = T;
+
+  HugeArena* arena{nullptr};
+
+  ArenaAllocator() = default;
+  explicit ArenaAllocator(HugeArena* a) : arena(a) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+  T* allocate(size_t n) {
+    if (arena)
+      if (void* p = arena->allocate(n * sizeof(T), alignof(T))) return static_cast<T*>(p);
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (arena && arena->owns(p)) return;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+};
+
+} // namespace lumina
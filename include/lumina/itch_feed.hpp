@@ -0,0 +1,134 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/feed_source.hpp"
+#include "lumina/itch_format.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+
+namespace lumina {
+
+/// Writes a capture in the itch_format.hpp layout (file header on
+/// construction), numbering messages from 1. For recording, tests and
+/// synthetic benchmark input; not used on the hot path.
+class ItchWriter {
+public:
+  explicit ItchWriter(std::ostream& out);
+
+  void add_order(TimestampNs ts_ns, OrderId id, Side side, Price price, uint32_t qty);
+  void cancel_order(TimestampNs ts_ns, OrderId id, uint32_t qty);
+  void delete_order(TimestampNs ts_ns, OrderId id);
+  void execute_order(TimestampNs ts_ns, OrderId id, uint32_t qty);
+  void replace_order(TimestampNs ts_ns, OrderId id, OrderId new_id, Price price, uint32_t qty);
+  void trade(TimestampNs ts_ns, Side side, Price price, uint32_t qty);
+
+  uint64_t messages() const { return seq_; }
+  bool ok() const;
+
+private:
+  template <typename M>
+  void write(M& msg, ItchType type, TimestampNs ts_ns);
+
+  std::ostream& out_;
+  uint64_t seq_{0};
+};
+
+/// Read-only mmap of a whole file. Move-only.
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+  MappedFile(MappedFile&& o) noexcept { *this = std::move(o); }
+  MappedFile& operator=(MappedFile&& o) noexcept;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// Map path; sequential-access advice is given to the kernel.
+  bool open(const std::string& path);
+  void close();
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const char* data_{nullptr};
+  size_t size_{0};
+};
+
+/// Decodes a capture in place: records are read straight out of the
+/// (mapped) buffer and only the normalised FeedMessage is written, so no
+/// bytes are copied or buffered in between. Unknown message types are
+/// skipped by length. A record that runs past the end or has a bad length
+/// stops decoding and sets error().
+class ItchDecoder {
+public:
+  ItchDecoder() = default;
+  /// data must start with the file header and be 8-byte aligned; check
+  /// valid() afterwards.
+  ItchDecoder(const char* data, size_t size);
+  /// Decoder over bare records with no file header (e.g. a packet payload).
+  static ItchDecoder records(const char* data, size_t size);
+
+  bool valid() const { return data_ != nullptr; }
+  /// Decode up to max messages into out; returns how many.
+  size_t decode(FeedMessage* out, size_t max);
+  /// Timestamp of the next record without consuming it; false at the end.
+  bool peek_ts(TimestampNs& ts) const;
+  /// Nothing more to decode (end of data or error).
+  bool done() const { return pos_ >= size_ || error_; }
+  bool error() const { return error_; }
+
+  uint64_t decoded() const { return decoded_; }
+  uint64_t skipped() const { return skipped_; }
+  size_t offset() const { return pos_; }
+
+private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  size_t pos_{0};
+  uint64_t decoded_{0};
+  uint64_t skipped_{0};
+  bool error_{false};
+};
+
+enum class ReplayPace : uint8_t {
+  MaxSpeed,  // hand out messages as fast as the handler takes them
+  Recorded,  // release each message when its capture timestamp comes due
+};
+
+struct ReplayOptions {
+  ReplayPace pace{ReplayPace::MaxSpeed};
+  double speed{1.0};  // Recorded pace multiplier (2.0 = twice as fast)
+};
+
+/// FeedSource that replays a capture file (or a caller-owned buffer) into
+/// MarketDataHandler. Recorded pacing anchors the first message to the
+/// wall clock at the first poll and then keeps the capture's spacing,
+/// scaled by speed; a slow consumer simply catches up with no sleeping.
+class ReplayFeedSource : public FeedSource {
+public:
+  explicit ReplayFeedSource(ReplayOptions options = {}) : options_(options) {}
+
+  /// mmap a capture file.
+  bool open(const std::string& path);
+  /// Replay bytes the caller keeps alive (8-byte aligned).
+  bool open_buffer(const char* data, size_t size);
+
+  size_t poll(FeedMessage* out, size_t max) override;
+  bool finished() const override { return decoder_.done(); }
+
+  const ItchDecoder& decoder() const { return decoder_; }
+
+private:
+  MappedFile file_;
+  ItchDecoder decoder_;
+  ReplayOptions options_;
+  TimestampNs wall_start_{0};
+  TimestampNs feed_start_{0};
+  bool started_{false};
+};
+
+} // namespace lumina
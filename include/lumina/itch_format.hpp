@@ -0,0 +1,110 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include <cstdint>
+
+namespace lumina {
+
+/// Layout of a binary order-flow capture, modelled on ITCH 5.0 but in
+/// native endianness with naturally aligned fields:
+///   ItchFileHeader, then messages back to back.
+/// Every message starts with ItchHeader and its size is a multiple of 8, so
+/// in an mmap'd file each record is 8-byte aligned and can be read in place.
+/// length lets a reader skip types it does not know. Bump ITCH_VERSION on
+/// any layout change; older files are rejected.
+constexpr char ITCH_MAGIC[4] = {'L', 'I', 'T', 'C'};
+constexpr uint16_t ITCH_VERSION = 1;
+
+struct ItchFileHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t reserved;
+};
+
+enum class ItchType : char {
+  AddOrder = 'A',
+  CancelOrder = 'X',   // partial cancel
+  DeleteOrder = 'D',
+  ExecuteOrder = 'E',
+  ReplaceOrder = 'U',
+  Trade = 'P',         // execution against a non-displayed order
+};
+
+struct ItchHeader {
+  uint16_t length;     // whole message, header included
+  ItchType type;
+  uint8_t reserved0;
+  uint32_t reserved1;
+  uint64_t seq;
+  TimestampNs ts_ns;
+};
+
+struct ItchAddOrder {
+  ItchHeader h;
+  OrderId id;
+  Price price;
+  uint32_t qty;
+  char side;           // 'B' or 'S'
+  uint8_t reserved[3];
+};
+
+struct ItchCancelOrder {
+  ItchHeader h;
+  OrderId id;
+  uint32_t qty;        // shares taken off
+  uint32_t reserved;
+};
+
+struct ItchDeleteOrder {
+  ItchHeader h;
+  OrderId id;
+};
+
+struct ItchExecuteOrder {
+  ItchHeader h;
+  OrderId id;
+  uint32_t qty;        // shares executed
+  uint32_t reserved;
+};
+
+struct ItchReplaceOrder {
+  ItchHeader h;
+  OrderId id;          // original order
+  OrderId new_id;
+  Price price;
+  uint32_t qty;
+  uint32_t reserved;
+};
+
+struct ItchTrade {
+  ItchHeader h;
+  Price price;
+  uint32_t qty;
+  char side;           // aggressor side, 'B' or 'S'
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(ItchFileHeader) == 8);
+static_assert(sizeof(ItchHeader) == 24);
+static_assert(sizeof(ItchAddOrder) == 48);
+static_assert(sizeof(ItchCancelOrder) == 40);
+static_assert(sizeof(ItchDeleteOrder) == 32);
+static_assert(sizeof(ItchExecuteOrder) == 40);
+static_assert(sizeof(ItchReplaceOrder) == 56);
+static_assert(sizeof(ItchTrade) == 40);
+
+/// Smallest length a record of type t may declare (its full struct); 0 for
+/// types this version does not know, which only need the common header.
+constexpr size_t min_len(ItchType t) {
+  switch (t) {
+  case ItchType::AddOrder: return sizeof(ItchAddOrder);
+  case ItchType::CancelOrder: return sizeof(ItchCancelOrder);
+  case ItchType::DeleteOrder: return sizeof(ItchDeleteOrder);
+  case ItchType::ExecuteOrder: return sizeof(ItchExecuteOrder);
+  case ItchType::ReplaceOrder: return sizeof(ItchReplaceOrder);
+  case ItchType::Trade: return sizeof(ItchTrade);
+  }
+  return 0;
+}
+
+} // namespace lumina
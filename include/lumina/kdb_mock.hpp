@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lumina/types.hpp"
+#include "lumina/huge_arena.hpp"
 #include <vector>
 #include <mutex>
 #include <optional>
@@ -20,6 +21,8 @@ struct TickRecord {
 class KDBMock {
 public:
   KDBMock() = default;
+  /// Tick store with reserve_ticks records preallocated from arena.
+  explicit KDBMock(HugeArena* arena, size_t reserve_ticks);
 
   void insert(const TickRecord& rec);
   void insert_trade(TimestampNs ts_ns, Price price, Qty qty);
@@ -30,7 +33,7 @@ public:
 
 private:
   mutable std::mutex mtx_;
-  std::vector<TickRecord> ticks_;
+  std::vector<TickRecord, ArenaAllocator<TickRecord>> ticks_;
 };
 
 } // namespace lumina
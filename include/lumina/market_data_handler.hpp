@@ -1,8 +1,14 @@
 #pragma once
 
 #include "lumina/types.hpp"
+#include "lumina/conflation.hpp"
+#include "lumina/feed_source.hpp"
 #include "lumina/order_book.hpp"
+#include "lumina/mbp_book.hpp"
 #include "lumina/ring_buffer.hpp"
+#include "lumina/top_of_book.hpp"
+#include "lumina/wait_strategy.hpp"
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <memory>
@@ -12,30 +18,120 @@ namespace lumina {
 
 constexpr size_t MD_RING_SIZE = 65536;
 
-/// Consumes raw updates (or simulated ticks), updates order book,
-/// and publishes MarketDataEvent to the strategy ring buffer.
+/// Book the handler maintains, chosen at build time (-DUSE_MBP_BOOK=ON for
+/// price-level feeds). Both expose the DepthBook read API.
+#if defined(LUMINA_MBP_BOOK)
+using MDBook = MbpBook;
+#else
+using MDBook = OrderBook;
+#endif
+static_assert(DepthBook<MDBook>);
+
+/// Net qty change at one price level.
+struct LevelChange {
+  Side side{Side::Buy};
+  Price price{0};
+  Qty delta{0};
+};
+
+constexpr int NO_CORE_PIN = -1;
+constexpr size_t MAX_FEED_BATCH = 256;
+
+struct MDHandlerOptions {
+  int core{1};            // CPU the handler thread pins to, or NO_CORE_PIN
+  IdleStrategy idle{};    // what the loop does while the feed is empty
+  size_t batch{64};       // max messages taken from the feed per pass
+};
+
+/// Handler-thread counters, readable from any thread. busy_ns covers
+/// decode, book update and publish for the batches that had messages, so
+/// busy_ns / messages is the mean per-event handler latency.
+struct MDLoopStats {
+  uint64_t messages{0};
+  uint64_t batches{0};
+  uint64_t busy_ns{0};
+  uint64_t max_batch_ns{0};
+  uint64_t idle_passes{0};
+  uint64_t conflated{0};  // book events parked in the conflation slot
+  uint64_t dropped{0};    // events lost to a full ring
+};
+
+/// Owns the market data ingest loop: the handler thread pulls decoded
+/// messages from a FeedSource, applies them to the book and publishes
+/// MarketDataEvent to the strategy ring buffer. Without a feed (or before
+/// start()) the on_* entry points can be called directly, but only from
+/// one thread at a time, and never while the loop is running.
 class MarketDataHandler {
 public:
   using MDRing = SPSCRingBuffer<MarketDataEvent, MD_RING_SIZE>;
 
-  explicit MarketDataHandler(std::shared_ptr<MDRing> to_strategy);
+  explicit MarketDataHandler(std::shared_ptr<MDRing> to_strategy,
+                             MDHandlerOptions options = {});
   ~MarketDataHandler();
 
+  /// Feed for the event loop; set before start(). The handler does not own it.
+  void set_feed(FeedSource* feed) { feed_ = feed; }
+  /// Conflation mode; set before start(). Once depth events are queued in
+  /// the ring, BookUpdate events are parked in slot (latest wins) instead,
+  /// as BestBidAsk events: a merged state has no single level change;
+  /// trades are always queued. Give the strategy the same slot. Without
+  /// it, events that do not fit the ring are dropped and counted.
+  void set_conflation(std::shared_ptr<ConflationSlot> slot, size_t depth) {
+    conflation_ = std::move(slot);
+    conflate_room_ = depth <= MDRing::capacity ? MDRing::capacity + 1 - depth : 0;
+  }
   void start();
   void stop();
-  OrderBook& order_book() { return book_; }
-  const OrderBook& order_book() const { return book_; }
+  /// One loop pass on the calling thread: take a batch from the feed and
+  /// apply it. Returns the number of messages handled.
+  size_t poll_feed();
+  /// The feed reported finished() and the loop handled everything it gave.
+  bool feed_finished() const { return feed_finished_.load(std::memory_order_acquire); }
+  MDLoopStats loop_stats() const;
+  /// Sequence number of the last feed message applied.
+  uint64_t last_seq() const { return last_seq_; }
+
+  MDBook& order_book() { return book_; }
+  const MDBook& order_book() const { return book_; }
+  /// Latest top of book, republished after every update. Safe to read from
+  /// any thread (seqlock); the book itself is handler-thread only.
+  const TopOfBookCell& top_of_book() const { return top_; }
 
   /// Feed a trade (e.g. from exchange or backtester).
   void on_trade(Price price, Qty qty, TimestampNs ts_ns);
-  /// Feed book update (add/cancel).
-  void on_book_update(Side side, Price price, Qty delta_qty, bool is_add);
+  /// Feed a price-level update: add delta_qty at price, or take it off
+  /// (is_add false), removing the level once it is empty. Publishes a
+  /// BookUpdate event with the change the book actually took (a removal is
+  /// capped at what the level held) and the new best prices; nothing when
+  /// the book did not change.
+  void on_book_update(Side side, Price price, Qty delta_qty, bool is_add,
+                      TimestampNs ts_ns = 0);
 
 private:
   void run();
+  void apply(const FeedMessage& msg);
+  void publish_trade(Price price, Qty qty, TimestampNs ts_ns, const LevelChange* executed);
+  void publish_delta(const LevelChange& change, TimestampNs ts_ns);
+  void publish(MarketDataEvent& ev, TimestampNs ts_ns);
 
   std::shared_ptr<MDRing> to_strategy_;
-  OrderBook book_;
+  std::shared_ptr<ConflationSlot> conflation_;
+  size_t conflate_room_{0};  // free slots below which book updates are parked
+  MDBook book_;
+  TopOfBookCell top_;
+  MDHandlerOptions options_;
+  FeedSource* feed_{nullptr};
+  std::array<FeedMessage, MAX_FEED_BATCH> batch_;
+  uint64_t last_seq_{0};
+  uint64_t seq_{0};  // events published; mirrors top_.seq()
+  std::atomic<uint64_t> messages_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> busy_ns_{0};
+  std::atomic<uint64_t> max_batch_ns_{0};
+  std::atomic<uint64_t> idle_passes_{0};
+  std::atomic<uint64_t> conflated_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<bool> feed_finished_{false};
   std::atomic<bool> running_{false};
   std::thread thread_;
 };
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/book_side.hpp"
+#include "lumina/memory_pool.hpp"
+
+namespace lumina {
+
+/// Market-by-price book for feeds aggregated by price level. Keeps only
+/// one aggregate (qty, order count) per level, updated by set/delete-level
+/// messages: no order nodes and no order-id index. Shares the depth, volume
+/// and best-price read API with OrderBook (see DepthBook).
+class MbpBook {
+public:
+  explicit MbpBook(size_t ladder_ticks = DEFAULT_LADDER_TICKS,
+                   size_t depth_levels = DEFAULT_DEPTH_LEVELS,
+                   size_t max_levels = DEFAULT_MAX_LEVELS,
+                   HugeArena* arena = nullptr);
+
+  /// Overwrite the aggregate at a level; qty <= 0 deletes it.
+  /// Returns false if the level pool is exhausted.
+  bool set_level(Side side, Price price, Qty qty, int count = 0);
+  void delete_level(Side side, Price price);
+  /// Signed change at a level (creating it if needed); deletes at qty <= 0.
+  /// Returns the change actually applied: a removal is capped at the qty
+  /// the level had, and 0 means nothing changed (or the pool is exhausted).
+  Qty apply_delta(Side side, Price price, Qty delta, int count_delta = 0);
+  /// Aggregate qty at price (0 if there is no such level).
+  Qty level_qty(Side side, Price price) const {
+    const PriceLevel* level = side_of(side).find(price);
+    return level ? level->total_qty : 0;
+  }
+  void clear();
+
+  Price best_bid() const;
+  Price best_ask() const;
+  Qty bid_volume() const { return bids_.volume(); }
+  Qty ask_volume() const { return asks_.volume(); }
+  Price mid_price() const;
+  BookLevel best_bid_level() const;
+  BookLevel best_ask_level() const;
+  void get_bid_ask_volumes(Qty& bid_vol, Qty& ask_vol) const {
+    bid_vol = bid_volume();
+    ask_vol = ask_volume();
+  }
+  Qty depth_qty(Side side) const { return side_of(side).top_qty(); }
+  size_t depth_levels() const { return bids_.depth_levels(); }
+
+  template <size_t N>
+  void snapshot_depth(size_t levels, DepthSnapshot<N>& out) const {
+    if (levels > N) levels = N;
+    out.bid_levels = bids_.copy(levels, out.bid_price.data(),
+                                out.bid_qty.data(), out.bid_count.data());
+    out.ask_levels = asks_.copy(levels, out.ask_price.data(),
+                                out.ask_qty.data(), out.ask_count.data());
+  }
+
+  const ChunkedPool<PriceLevel>& level_pool() const { return level_pool_; }
+
+private:
+  BookSide& side_of(Side side) { return side == Side::Buy ? bids_ : asks_; }
+  const BookSide& side_of(Side side) const { return side == Side::Buy ? bids_ : asks_; }
+
+  ChunkedPool<PriceLevel> level_pool_;
+  BookSide bids_;
+  BookSide asks_;
+};
+
+} // namespace lumina
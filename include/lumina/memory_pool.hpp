@@ -1,76 +1,247 @@
 #pragma once
 
 #include "lumina/types.hpp"
+#include "lumina/huge_arena.hpp"
 #include <array>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <vector>
 
 namespace lumina {
 
+constexpr size_t MAX_POOL_THREADS = 64;
+
+/// Dense id of the calling thread (0, 1, ...) used to pick its magazine in
+/// every MemoryPool. Ids are recycled when threads exit; a thread beyond
+/// MAX_POOL_THREADS live threads gets MAX_POOL_THREADS and uses the shared
+/// free list directly.
+uint32_t acquire_pool_thread_slot();
+inline thread_local uint32_t tls_pool_thread_slot = UINT32_MAX;
+inline uint32_t pool_thread_slot() {
+  uint32_t slot = tls_pool_thread_slot;
+  if (slot == UINT32_MAX) [[unlikely]]
+    slot = tls_pool_thread_slot = acquire_pool_thread_slot();
+  return slot;
+}
+
 /// Fixed-size block pool: no malloc/new on the hot path.
-/// All blocks are pre-allocated at startup; alloc/free are lock-free push/pop.
-template <typename T, size_t Capacity>
+/// All blocks are pre-allocated at startup. The shared free list is a
+/// Treiber stack of block indices whose head carries a generation tag, so a
+/// pop that raced with pop/push/pop of the same block fails its CAS (no
+/// ABA). Each thread also owns a magazine of up to MagazineSize free block
+/// indices: allocate/deallocate normally touch only the caller's magazine,
+/// and the shared list is hit once per MagazineSize / 2 operations to
+/// refill or spill half a magazine. MagazineSize 0 disables magazines.
+///
+/// The shared list keeps a count of blocks taken from it, so size_used() is
+/// that count minus the blocks cached in magazines (O(MAX_POOL_THREADS),
+/// independent of Capacity). high_water() is the peak of blocks taken from
+/// the shared list, i.e. in use or cached, so within a magazine per thread
+/// of the true peak. A thread that stops using the pool
+/// should call drain_local() so its cached blocks go back to the others.
+template <typename T, size_t Capacity, size_t MagazineSize = 32>
 class MemoryPool {
 public:
+  static_assert(Capacity > 0 && Capacity < (uint64_t{1} << 32) - 1);
   static constexpr size_t capacity = Capacity;
+  static constexpr size_t magazine_size = MagazineSize;
 
   MemoryPool() {
     for (size_t i = 0; i < Capacity; ++i)
-      slots_[i].next.store(&slots_[i + 1], std::memory_order_relaxed);
-    slots_[Capacity - 1].next.store(nullptr, std::memory_order_relaxed);
-    head_.store(&slots_[0], std::memory_order_relaxed);
+      next_[i].store(static_cast<uint32_t>(i + 2 <= Capacity ? i + 2 : 0),
+                     std::memory_order_relaxed);
+    head_.store(1, std::memory_order_relaxed);  // tag 0, block 0
   }
 
   T* allocate() {
-    Node* n = head_.load(std::memory_order_acquire);
-    while (n && !head_.compare_exchange_weak(n, n->next.load(std::memory_order_relaxed),
-                                             std::memory_order_acq_rel,
-                                             std::memory_order_acquire))
-      ;
-    if (!n) return nullptr;
-    n->next.store(nullptr, std::memory_order_relaxed);
-    return &n->value;
+    const uint32_t slot = MagazineSize ? pool_thread_slot() : MAX_POOL_THREADS;
+    if (slot >= MAX_POOL_THREADS) {
+      uint32_t idx;
+      return pop_chain(1, &idx) ? block(idx) : nullptr;
+    }
+    Magazine& m = mags_[slot];
+    uint32_t count = m.count.load(std::memory_order_relaxed);
+    if (count == 0 && (count = pop_chain(REFILL, m.items)) == 0) return nullptr;
+    m.count.store(--count, std::memory_order_relaxed);
+    return block(m.items[count]);
   }
 
   void deallocate(T* p) {
     if (!p) return;
-    Node* n = reinterpret_cast<Node*>(p);
-    Node* old_head = head_.load(std::memory_order_acquire);
-    do {
-      n->next.store(old_head, std::memory_order_relaxed);
-    } while (!head_.compare_exchange_weak(old_head, n,
-                                          std::memory_order_acq_rel,
-                                          std::memory_order_acquire));
+    const auto idx = static_cast<uint32_t>(reinterpret_cast<Slot*>(p) - slots_.data());
+    const uint32_t slot = MagazineSize ? pool_thread_slot() : MAX_POOL_THREADS;
+    if (slot >= MAX_POOL_THREADS) {
+      push_chain(&idx, 1);
+      return;
+    }
+    Magazine& m = mags_[slot];
+    uint32_t count = m.count.load(std::memory_order_relaxed);
+    if (count == MagazineSize) {
+      count -= REFILL;
+      push_chain(m.items + count, REFILL);
+    }
+    m.items[count] = idx;
+    m.count.store(count + 1, std::memory_order_relaxed);
+  }
+
+  /// Return the calling thread's cached blocks to the shared list.
+  void drain_local() {
+    const uint32_t slot = MagazineSize ? pool_thread_slot() : MAX_POOL_THREADS;
+    if (slot >= MAX_POOL_THREADS) return;
+    Magazine& m = mags_[slot];
+    if (const uint32_t count = m.count.load(std::memory_order_relaxed)) push_chain(m.items, count);
+    m.count.store(0, std::memory_order_relaxed);
   }
 
+  /// Blocks handed out and not yet returned (exact when quiescent).
   size_t size_used() const {
-    size_t count = 0;
-    Node* n = head_.load(std::memory_order_acquire);
-    while (n) {
-      ++count;
-      n = n->next.load(std::memory_order_acquire);
-    }
-    return Capacity - count;
+    size_t used = taken_.load(std::memory_order_relaxed);
+    for (const Magazine& m : mags_) used -= m.count.load(std::memory_order_relaxed);
+    return used;
   }
+  size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
 
 private:
-  union Node {
-    T value;
-    std::atomic<Node*> next;
-    Node() : next(nullptr) {}
-    ~Node() {}
+  static constexpr uint32_t REFILL = static_cast<uint32_t>(MagazineSize / 2 ? MagazineSize / 2 : 1);
+
+  struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
   };
-  alignas(64) std::array<Node, Capacity> slots_;
-  alignas(64) std::atomic<Node*> head_;
+
+  struct alignas(64) Magazine {
+    std::atomic<uint32_t> count{0};  // owner-written, read by size_used()
+    uint32_t items[MagazineSize ? MagazineSize : 1];
+  };
+
+  // head_: generation tag in the high 32 bits, index + 1 of the top block
+  // in the low 32 bits (0 = empty). next_ holds index + 1 links.
+  static uint32_t top(uint64_t head) { return static_cast<uint32_t>(head); }
+  static uint64_t make_head(uint64_t head, uint32_t top) {
+    return ((head >> 32) + 1) << 32 | top;
+  }
+
+  T* block(uint32_t idx) { return std::launder(reinterpret_cast<T*>(slots_[idx].storage)); }
+
+  /// Pop up to n blocks in one CAS; returns how many were written to out.
+  uint32_t pop_chain(uint32_t n, uint32_t* out) {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint32_t got;
+    for (;;) {
+      got = 0;
+      uint32_t link = top(head);
+      while (link && got < n) {
+        out[got++] = link - 1;
+        link = next_[link - 1].load(std::memory_order_relaxed);
+      }
+      if (got == 0) return 0;
+      if (head_.compare_exchange_weak(head, make_head(head, link),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire))
+        break;
+    }
+    const size_t taken = taken_.fetch_add(got, std::memory_order_relaxed) + got;
+    size_t hw = high_water_.load(std::memory_order_relaxed);
+    while (taken > hw && !high_water_.compare_exchange_weak(hw, taken, std::memory_order_relaxed))
+      ;
+    return got;
+  }
+
+  /// Push n blocks as one pre-linked chain with one CAS.
+  void push_chain(const uint32_t* idx, uint32_t n) {
+    for (uint32_t i = 0; i + 1 < n; ++i)
+      next_[idx[i]].store(idx[i + 1] + 1, std::memory_order_relaxed);
+    std::atomic<uint32_t>& tail = next_[idx[n - 1]];
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    do {
+      tail.store(top(head), std::memory_order_relaxed);
+    } while (!head_.compare_exchange_weak(head, make_head(head, idx[0] + 1),
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+    taken_.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  std::array<Slot, Capacity> slots_;
+  std::array<std::atomic<uint32_t>, Capacity> next_;
+  alignas(64) std::atomic<uint64_t> head_;
+  alignas(64) std::atomic<size_t> taken_{0};  // blocks outside the shared list
+  std::atomic<size_t> high_water_{0};
+  std::array<Magazine, MAX_POOL_THREADS> mags_{};
+};
+
+/// Runtime-sized object pool made of fixed-size chunks. Pointers never move:
+/// when a chunk is exhausted a new one is appended instead of reallocating.
+/// Freed objects are recycled LIFO, so memory is bounded by the peak number
+/// of live objects rather than by the total ever allocated. Chunks come
+/// from arena when one is given.
+template <typename T>
+class ChunkedPool {
+public:
+  explicit ChunkedPool(size_t chunk_size, size_t max_chunks = 64,
+                       HugeArena* arena = nullptr)
+    : chunk_size_(chunk_size ? chunk_size : 1), max_chunks_(max_chunks), alloc_(arena) {
+    chunks_.reserve(max_chunks_);
+    add_chunk();
+  }
+  ~ChunkedPool() {
+    for (T* chunk : chunks_) {
+      std::destroy_n(chunk, chunk_size_);
+      alloc_.deallocate(chunk, chunk_size_);
+    }
+  }
+  ChunkedPool(const ChunkedPool&) = delete;
+  ChunkedPool& operator=(const ChunkedPool&) = delete;
+
+  /// Returns a value-initialised object, or nullptr once max_chunks is hit.
+  T* allocate() {
+    if (free_list_.empty() && !add_chunk()) return nullptr;
+    T* p = free_list_.back();
+    free_list_.pop_back();
+    *p = T{};
+    if (++used_ > high_water_) high_water_ = used_;
+    return p;
+  }
+
+  void deallocate(T* p) {
+    if (!p) return;
+    free_list_.push_back(p);
+    --used_;
+  }
+
+  size_t size_used() const { return used_; }
+  size_t capacity() const { return chunks_.size() * chunk_size_; }
+  size_t high_water() const { return high_water_; }
+  size_t chunk_count() const { return chunks_.size(); }
+
+private:
+  bool add_chunk() {
+    if (chunks_.size() >= max_chunks_) return false;
+    T* block = alloc_.allocate(chunk_size_);
+    std::uninitialized_value_construct_n(block, chunk_size_);
+    chunks_.push_back(block);
+    free_list_.reserve(capacity());
+    for (size_t i = chunk_size_; i > 0; --i)
+      free_list_.push_back(&block[i - 1]);
+    return true;
+  }
+
+  size_t chunk_size_;
+  size_t max_chunks_;
+  ArenaAllocator<T> alloc_;
+  std::vector<T*> chunks_;
+  std::vector<T*> free_list_;
+  size_t used_{0};
+  size_t high_water_{0};
 };
 
 /// Heap-backed pool for runtime-sized allocation (e.g. order book nodes).
-/// Still pre-allocates a contiguous block to avoid per-node malloc.
+/// Still pre-allocates a contiguous block to avoid per-node malloc; the
+/// block and free list come from arena when one is given.
 class OrderNodePool {
 public:
-  explicit OrderNodePool(size_t max_orders);
+  explicit OrderNodePool(size_t max_orders, HugeArena* arena = nullptr);
   ~OrderNodePool();
 
   struct Node {
@@ -85,8 +256,8 @@ public:
   size_t capacity() const { return capacity_; }
 
 private:
-  std::vector<Node> block_;
-  std::vector<Node*> free_list_;
+  std::vector<Node, ArenaAllocator<Node>> block_;
+  std::vector<Node*, ArenaAllocator<Node*>> free_list_;
   size_t capacity_{0};
   size_t used_{0};
   size_t free_idx_{0};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace lumina {
+
+/// Single-producer, multi-consumer sequenced ring (Disruptor-style
+/// multicast). Every consumer sees every event: the producer writes each
+/// event once and each consumer advances its own cursor. A consumer may
+/// depend on others (e.g. a recorder that runs after the strategy) and then
+/// only reads events they have already passed. The producer is gated by the
+/// slowest consumer, so nothing is overwritten before everyone has read it.
+///
+/// Consumers are registered before publishing starts; ids are dense from 0,
+/// one thread per id. Each side caches the indices it depends on and only
+/// reloads them when it looks blocked.
+template <typename T, size_t Size, size_t MaxConsumers = 8>
+class MulticastRing {
+public:
+  static_assert((Size & (Size - 1)) == 0, "Size must be power of 2");
+  static constexpr size_t capacity = Size;
+  static constexpr size_t mask = Size - 1;
+
+  /// Register a consumer that reads after the producer and after every
+  /// consumer in deps (which must already be registered; repeats count
+  /// once). Returns its id, or -1 if the ring is full of consumers or a dep
+  /// is unknown.
+  int add_consumer(std::initializer_list<int> deps = {}) {
+    if (consumer_count_ == MaxConsumers) return -1;
+    Consumer& c = consumers_[consumer_count_];
+    for (int d : deps) {
+      if (d < 0 || static_cast<size_t>(d) >= consumer_count_) return -1;
+    }
+    // Distinct known ids are below consumer_count_ < MaxConsumers, so the
+    // deduplicated list always fits.
+    for (int d : deps) {
+      if (std::find(c.deps, c.deps + c.dep_count, d) == c.deps + c.dep_count)
+        c.deps[c.dep_count++] = d;
+    }
+    c.cursor.store(write_pos_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    c.limit_cache = c.cursor.load(std::memory_order_relaxed);
+    return static_cast<int>(consumer_count_++);
+  }
+
+  // ---- producer ----
+
+  /// Next slot to fill in place, or nullptr while the slowest consumer is a
+  /// full ring behind. The slot is published by publish().
+  T* claim() {
+    const uint64_t w = write_pos_.load(std::memory_order_relaxed);
+    return free_slots(w, 1) ? &buffer_[w & mask] : nullptr;
+  }
+  void publish() {
+    write_pos_.store(write_pos_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+  }
+
+  bool try_publish(const T& item) {
+    T* slot = claim();
+    if (!slot) return false;
+    *slot = item;
+    publish();
+    return true;
+  }
+
+  /// Publish up to n items with one cursor store; returns how many.
+  size_t try_publish_n(const T* items, size_t n) {
+    const uint64_t w = write_pos_.load(std::memory_order_relaxed);
+    n = std::min<size_t>(n, free_slots(w, n));
+    if (n == 0) return 0;
+    const size_t first = std::min(n, Size - (w & mask));
+    std::copy_n(items, first, buffer_ + (w & mask));
+    std::copy_n(items + first, n - first, buffer_);
+    write_pos_.store(w + n, std::memory_order_release);
+    return n;
+  }
+
+  // ---- consumers ----
+
+  /// Events consumer id may read now (published and passed by its deps).
+  /// The shared cursors are only re-read once the cached limit has been
+  /// consumed, so this can under-report while the producer is ahead.
+  size_t available(int id) {
+    Consumer& c = consumers_[id];
+    const uint64_t r = c.cursor.load(std::memory_order_relaxed);
+    if (c.limit_cache == r) c.limit_cache = limit(c);
+    return static_cast<size_t>(c.limit_cache - r);
+  }
+
+  /// i-th readable event of consumer id (i < available(id)), read in place.
+  const T& at(int id, size_t i) const {
+    return buffer_[(consumers_[id].cursor.load(std::memory_order_relaxed) + i) & mask];
+  }
+
+  /// Hand n events back; they become visible to dependents and the producer.
+  void release(int id, size_t n) {
+    std::atomic<uint64_t>& cursor = consumers_[id].cursor;
+    cursor.store(cursor.load(std::memory_order_relaxed) + n, std::memory_order_release);
+  }
+
+  /// Batch read: call f on up to max readable events in order, then release
+  /// them with a single cursor store. Returns the number processed.
+  template <typename F>
+  size_t poll(int id, F&& f, size_t max = Size) {
+    const size_t n = std::min(available(id), max);
+    const uint64_t r = consumers_[id].cursor.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) f(buffer_[(r + i) & mask]);
+    if (n) release(id, n);
+    return n;
+  }
+
+  uint64_t published() const { return write_pos_.load(std::memory_order_acquire); }
+  uint64_t cursor(int id) const {
+    return consumers_[id].cursor.load(std::memory_order_acquire);
+  }
+  size_t consumer_count() const { return consumer_count_; }
+
+private:
+  struct alignas(64) Consumer {
+    std::atomic<uint64_t> cursor{0};  // next sequence to read
+    uint64_t limit_cache{0};          // owner's view of its read limit
+    size_t dep_count{0};
+    int deps[MaxConsumers]{};
+  };
+
+  uint64_t limit(const Consumer& c) const {
+    uint64_t lim = write_pos_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < c.dep_count; ++i)
+      lim = std::min(lim, consumers_[c.deps[i]].cursor.load(std::memory_order_acquire));
+    return lim;
+  }
+
+  size_t free_slots(uint64_t w, size_t want) {
+    uint64_t free = Size - (w - gate_cache_);
+    if (free < want) {
+      // Dependents never pass their deps, so the minimum over all cursors
+      // is the minimum over the leaves.
+      uint64_t gate = w;
+      for (size_t i = 0; i < consumer_count_; ++i)
+        gate = std::min(gate, consumers_[i].cursor.load(std::memory_order_acquire));
+      gate_cache_ = gate;
+      free = Size - (w - gate_cache_);
+    }
+    return static_cast<size_t>(free);
+  }
+
+  alignas(64) std::atomic<uint64_t> write_pos_{0};
+  uint64_t gate_cache_{0};  // producer's view of the slowest cursor
+  size_t consumer_count_{0};
+  Consumer consumers_[MaxConsumers];
+  alignas(64) T buffer_[Size];
+};
+
+} // namespace lumina
@@ -2,35 +2,79 @@
 
 #include "lumina/types.hpp"
 #include "lumina/memory_pool.hpp"
-#include <vector>
-#include <unordered_map>
-#include <atomic>
+#include "lumina/order_index.hpp"
+#include "lumina/book_side.hpp"
+#include "lumina/scratch_arena.hpp"
+#include <iosfwd>
 
 namespace lumina {
 
-/// Price level: doubly-linked list of orders for time priority.
-struct PriceLevel {
-  Price price{0};
-  Qty total_qty{0};
-  OrderNodePool::Node* head{nullptr};
-  OrderNodePool::Node* tail{nullptr};
-  PriceLevel* prev{nullptr};
-  PriceLevel* next{nullptr};
-};
-
-/// Limit Order Book with O(1) price-level lookup via hash map and
-/// doubly-linked price levels. All allocations from pool.
+/// Limit Order Book with O(1) price-level lookup via tick-indexed ladders
+/// and doubly-linked price levels. All allocations from pool.
+/// Side volumes, per-level order counts and top-N cumulative depth are
+/// maintained incrementally, so every aggregate accessor is O(1).
+/// Price levels come from a chunked pool sized by max_levels; emptied levels
+/// are recycled and level pointers stay valid for the book's lifetime.
+/// Orders are indexed by id in a flat table sized from max_orders.
+/// Order nodes, level chunks and the id table come from arena if given.
 class OrderBook {
 public:
-  explicit OrderBook(size_t max_orders = 1 << 20);
+  explicit OrderBook(size_t max_orders = 1 << 20,
+                     size_t ladder_ticks = DEFAULT_LADDER_TICKS,
+                     size_t depth_levels = DEFAULT_DEPTH_LEVELS,
+                     size_t max_levels = DEFAULT_MAX_LEVELS,
+                     HugeArena* arena = nullptr);
   ~OrderBook() = default;
 
-  bool add_order(OrderId id, Price price, Qty qty, Side side);
+  /// Rest an order without matching (book building from an order-level feed,
+  /// where the exchange has already matched). Returns false on duplicate id,
+  /// bad qty or exhausted pools.
+  bool add_order(OrderId id, Price price, Qty qty, Side side, TimestampNs ts_ns = 0);
   void cancel_order(OrderId id);
   void cancel_order(OrderId id, Price price, Side side);
+  /// Take qty off a resting order in place (feed partial cancel or
+  /// execution), keeping its queue priority; the order is removed once
+  /// nothing is left. Returns the qty actually removed.
+  Qty reduce_order(OrderId id, Qty qty);
+  /// Resting order by id, or nullptr.
+  const Order* find_order(OrderId id) const;
+
+  /// Price-level update from an aggregated feed, same call as on MbpBook.
+  /// The level's feed qty is held as one synthetic order per price (id from
+  /// level_order_id, so real order ids must stay below 2^63); it grows in
+  /// place and shrinks or is removed by negative deltas. count_delta is
+  /// ignored: the level count is the number of resting orders. Returns the
+  /// change actually applied: a removal is capped at the feed qty resting
+  /// there, and 0 means nothing changed (or the order pool is exhausted).
+  Qty apply_delta(Side side, Price price, Qty delta, int count_delta = 0);
+  static constexpr OrderId level_order_id(Side side, Price price) {
+    return (OrderId{1} << 63) | (side == Side::Sell ? OrderId{1} << 62 : 0) |
+           (static_cast<OrderId>(price) & ((OrderId{1} << 62) - 1));
+  }
+  /// Total qty resting at price (0 if there is no such level).
+  Qty level_qty(Side side, Price price) const;
+
+  /// Price-time matching entry point: a limit order that crosses the spread
+  /// trades against resting orders (best price first, FIFO within a level)
+  /// before any remainder rests according to tif. post_only orders that
+  /// would cross are rejected. Fills carry both order ids and ts_ns and are
+  /// appended to fills (give it the event's ScratchArena to avoid the heap).
+  ExecReport submit_order(OrderId id, Price price, Qty qty, Side side,
+                          TimeInForce tif, bool post_only, TimestampNs ts_ns,
+                          FillSink& fills);
+
+  /// Modify a resting order. Reducing qty at the same price is done in place
+  /// and keeps queue priority; qty 0 cancels. A price change or size
+  /// increase loses priority and is re-submitted as GTC (and may trade).
+  /// A post-only order stays post-only: a modify that would cross is
+  /// Rejected and leaves it resting unchanged. Cancelled with leaves 0 means
+  /// the remainder could not rest again and the order is gone.
+  ExecReport modify_order(OrderId id, Price price, Qty qty, TimestampNs ts_ns,
+                          FillSink& fills);
 
-  /// Match incoming aggressive order (simplified: fill at price levels).
-  void match(Side side, Qty qty, std::vector<Trade>& fills);
+  /// Market order: sweep the opposite side for up to qty. Returns qty filled.
+  Qty match(Side side, Qty qty, FillSink& fills,
+            OrderId taker_id = 0, TimestampNs ts_ns = 0);
 
   Price best_bid() const;
   Price best_ask() const;
@@ -42,21 +86,57 @@ public:
 
   /// Fill depth for OBI / analytics
   void get_bid_ask_volumes(Qty& bid_vol, Qty& ask_vol) const;
+  /// Cumulative qty resting in the best depth_levels() levels of a side.
+  Qty depth_qty(Side side) const;
+  size_t depth_levels() const { return bids_.depth_levels(); }
+
+  /// Copy the best min(levels, N) levels per side into out in one pass over
+  /// the sorted level links. No allocation.
+  template <size_t N>
+  void snapshot_depth(size_t levels, DepthSnapshot<N>& out) const {
+    if (levels > N) levels = N;
+    out.bid_levels = bids_.copy(levels, out.bid_price.data(),
+                                out.bid_qty.data(), out.bid_count.data());
+    out.ask_levels = asks_.copy(levels, out.ask_price.data(),
+                                out.ask_qty.data(), out.ask_count.data());
+  }
+
+  /// Remove every order and level.
+  void clear();
+
+  /// Binary checkpoint of all resting orders (see book_snapshot.hpp), tagged
+  /// with the feed sequence number the book state reflects. Call between
+  /// updates so the snapshot is a consistent point in the sequence.
+  bool save_snapshot(std::ostream& out, uint64_t seq) const;
+  /// Replace the book with a checkpoint in one linear pass: levels are
+  /// appended best-to-worst and orders FIFO, skipping the level lookups and
+  /// duplicate checks of add_order. Returns false (leaving the book empty)
+  /// on a bad magic/version, a truncated stream, a pool/index overflow, an
+  /// order count that differs from the header or a crossed book.
+  bool load_snapshot(std::istream& in, uint64_t& seq);
+
+  /// Pool usage stats (levels in use, high-water mark, chunks, orders).
+  const ChunkedPool<PriceLevel>& level_pool() const { return level_pool_; }
+  const OrderNodePool& order_pool() const { return pool_; }
 
 private:
-  using PriceToLevel = std::unordered_map<Price, PriceLevel*>;
   OrderNodePool pool_;
-  std::vector<PriceLevel> level_storage_;
-  PriceToLevel bid_levels_;
-  PriceToLevel ask_levels_;
-  std::unordered_map<OrderId, OrderNodePool::Node*> order_index_;
-  PriceLevel* best_bid_{nullptr};
-  PriceLevel* best_ask_{nullptr};
-  mutable std::atomic<Price> cached_mid_{0};
-
-  PriceLevel* get_or_create_level(Price price, Side side);
+  ChunkedPool<PriceLevel> level_pool_;
+  BookSide bids_;
+  BookSide asks_;
+  OrderIdMap<OrderNodePool::Node*> order_index_;
+
+  BookSide& side_of(Side side) { return side == Side::Buy ? bids_ : asks_; }
+  const BookSide& side_of(Side side) const { return side == Side::Buy ? bids_ : asks_; }
+  BookSide& contra_of(Side side) { return side == Side::Buy ? asks_ : bids_; }
+  const BookSide& contra_of(Side side) const { return side == Side::Buy ? asks_ : bids_; }
   void remove_level_if_empty(PriceLevel* level, Side side);
-  void update_best(Side side);
+  void unlink_order(PriceLevel* level, OrderNodePool::Node* node);
+  OrderNodePool::Node* rest_order(OrderId id, Price price, Qty qty, Side side,
+                                  bool post_only, TimestampNs ts_ns);
+  Qty fillable_qty(Side side, Price limit, Qty needed) const;
+  Qty sweep(Side side, Price limit, Qty qty, OrderId taker_id, TimestampNs ts_ns,
+            FillSink& fills);
 };
 
 } // namespace lumina
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/huge_arena.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace lumina {
+
+/// Flat open-addressing map from OrderId to a pointer-like value, using
+/// Robin Hood probing with backward-shift deletion. The table is sized once
+/// from the expected number of live orders (load factor <= 0.5) and never
+/// allocates afterwards (from arena when one is given). A
+/// default-constructed V (nullptr) means "absent".
+template <typename V>
+class OrderIdMap {
+public:
+  explicit OrderIdMap(size_t max_entries, HugeArena* arena = nullptr)
+    : slots_(std::bit_ceil(std::max<size_t>(16, max_entries * 2)), Slot{},
+             ArenaAllocator<Slot>(arena)),
+      mask_(slots_.size() - 1),
+      shift_(64 - std::countr_zero(slots_.size())),
+      max_entries_(max_entries) {}
+
+  /// Insert a new key. Returns false if the key exists or the map is full.
+  bool insert(OrderId key, V value) {
+    if (size_ >= max_entries_) return false;
+    Slot cur{key, value, 1};
+    bool displaced = false;
+    for (size_t idx = home(key);; idx = (idx + 1) & mask_, ++cur.dist) {
+      Slot& s = slots_[idx];
+      if (s.dist == 0) {
+        s = cur;
+        ++size_;
+        return true;
+      }
+      if (!displaced && s.key == key) return false;
+      if (s.dist < cur.dist) {
+        std::swap(s, cur);
+        displaced = true;
+      }
+    }
+  }
+
+  V find(OrderId key) const {
+    for (size_t idx = home(key), dist = 1;; idx = (idx + 1) & mask_, ++dist) {
+      const Slot& s = slots_[idx];
+      if (s.dist < dist) return V{};
+      if (s.key == key) return s.value;
+    }
+  }
+
+  bool contains(OrderId key) const { return find(key) != V{}; }
+
+  /// Remove key and return its value (V{} if absent).
+  V erase(OrderId key) {
+    size_t idx = home(key);
+    for (uint32_t dist = 1;; idx = (idx + 1) & mask_, ++dist) {
+      const Slot& s = slots_[idx];
+      if (s.dist < dist) return V{};
+      if (s.key == key) break;
+    }
+    V value = slots_[idx].value;
+    for (size_t next = (idx + 1) & mask_; slots_[next].dist > 1;
+         idx = next, next = (next + 1) & mask_) {
+      slots_[idx] = slots_[next];
+      --slots_[idx].dist;
+    }
+    slots_[idx] = Slot{};
+    --size_;
+    return value;
+  }
+
+  void clear() {
+    for (auto& s : slots_) s = Slot{};
+    size_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t max_entries() const { return max_entries_; }
+  size_t slot_count() const { return slots_.size(); }
+
+private:
+  struct Slot {
+    OrderId key{0};
+    V value{};
+    uint32_t dist{0};  // probe distance + 1; 0 = empty
+  };
+
+  size_t home(OrderId key) const {
+    // Fibonacci hashing: spreads sequential exchange ids across the table.
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+  }
+
+  std::vector<Slot, ArenaAllocator<Slot>> slots_;
+  size_t mask_;
+  int shift_;
+  size_t max_entries_;
+  size_t size_{0};
+};
+
+} // namespace lumina
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace lumina {
+
+struct PriceLevel;
+
+constexpr size_t DEFAULT_LADDER_TICKS = 4096;
+
+/// Tick-indexed price ladder for one side of the book.
+/// Levels near the touch live in a contiguous window of slots indexed by
+/// price; a two-level occupancy bitmap finds the best level with two
+/// find-first-set scans. Far-away prices go to a sorted overflow.
+///
+/// Prices are mapped to keys ordered best-first (bids: -price, asks: price).
+/// Invariant: when non-empty, the best level is inside the window and every
+/// overflow key lies beyond the window's far edge. The window slides (by
+/// re-anchoring) when a better price arrives below it or when it drains.
+class PriceLadder {
+public:
+  PriceLadder(Side side, size_t window_ticks = DEFAULT_LADDER_TICKS);
+
+  PriceLevel* find(Price price) const;
+  void insert(Price price, PriceLevel* level);
+  void erase(Price price);
+
+  /// Best level (highest bid / lowest ask), nullptr if empty. O(window/4096).
+  PriceLevel* best() const;
+  /// Nearest stored level strictly worse / better than price, or nullptr.
+  PriceLevel* next_worse(Price price) const;
+  PriceLevel* next_better(Price price) const;
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t window_ticks() const { return slots_.size(); }
+  size_t overflow_size() const { return overflow_.size(); }
+
+  /// Visit levels best-first.
+  template <typename F>
+  void for_each(F&& f) const {
+    for (size_t w = 0; w < bits_.size(); ++w) {
+      uint64_t word = bits_[w];
+      while (word) {
+        f(slots_[w * 64 + std::countr_zero(word)]);
+        word &= word - 1;
+      }
+    }
+    for (const auto& e : overflow_) f(e.second);
+  }
+
+private:
+  int64_t key(Price price) const { return side_ == Side::Buy ? -price : price; }
+  bool in_window(int64_t k) const {
+    return k >= base_ && k - base_ < static_cast<int64_t>(slots_.size());
+  }
+  static constexpr size_t npos = static_cast<size_t>(-1);
+  size_t next_set(size_t from) const;     // lowest occupied slot >= from
+  size_t prev_set(size_t before) const;   // highest occupied slot < before
+  void set_slot(size_t idx, PriceLevel* level);
+  void clear_slot(size_t idx);
+  void reanchor(int64_t new_base);
+
+  Side side_;
+  int64_t base_{0};
+  size_t size_{0};
+  size_t window_count_{0};
+  std::vector<PriceLevel*> slots_;
+  std::vector<uint64_t> bits_;     // one bit per slot
+  std::vector<uint64_t> summary_;  // one bit per non-zero word of bits_
+  std::vector<std::pair<int64_t, PriceLevel*>> overflow_;  // sorted by key
+};
+
+} // namespace lumina
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include <cstdint>
+#include <functional>
+
+namespace lumina {
+
+struct QuoteManagerOptions {
+  Price tick_size{1};            // quotes are rounded to a multiple of this
+  Price min_requote_ticks{1};    // move a resting quote only this far or more
+  uint32_t max_msgs_per_sec{0};  // outbound budget, bursts up to one second's worth; 0: unlimited
+  OrderId first_order_id{1};
+};
+
+/// Outbound message counters.
+struct QuoteStats {
+  uint64_t news{0};
+  uint64_t replaces{0};
+  uint64_t cancels{0};
+  uint64_t held{0};       // target within min_requote_ticks of the resting quote
+  uint64_t throttled{0};  // change wanted but over the message budget
+};
+
+/// Our resting order on one side; id 0 when there is none.
+struct LiveQuote {
+  OrderId id{0};
+  Price price{0};
+  Qty qty{0};
+};
+
+/// Live-order state for a two-sided quote. The strategy states the quote
+/// it wants on every event; the manager compares it with what is resting
+/// and sends a new order, a cancel/replace or a cancel only when the
+/// price or the size actually changed. Price moves under
+/// min_requote_ticks are held, and new orders and replaces are metered by
+/// a message budget (GCRA on the caller's clock). Cancels are never held
+/// back, but count against the budget.
+class QuoteManager {
+public:
+  using OrderCallback = std::function<void(OrderId, Price, Qty, Side, bool is_bid)>;
+  using ReplaceCallback =
+      std::function<void(OrderId orig_id, OrderId id, Price, Qty, Side, bool is_bid)>;
+  using CancelCallback = std::function<void(OrderId)>;
+
+  explicit QuoteManager(QuoteManagerOptions options = {}) { set_options(options); }
+
+  void set_options(const QuoteManagerOptions& options);
+  void set_order_callback(OrderCallback cb) { order_cb_ = std::move(cb); }
+  /// Without a replace callback a requote is sent as cancel + new.
+  void set_replace_callback(ReplaceCallback cb) { replace_cb_ = std::move(cb); }
+  void set_cancel_callback(CancelCallback cb) { cancel_cb_ = std::move(cb); }
+
+  /// Nearest price on the tick grid. Round a model price once with this,
+  /// risk-check the result and pass the same price to update().
+  Price round_to_tick(double price) const;
+  /// Bring our quote on side to price (on the tick grid) and qty; qty <= 0
+  /// pulls it. now_ns drives the message budget.
+  void update(Side side, Price price, Qty qty, TimestampNs now_ns);
+  void cancel_all(TimestampNs now_ns);
+
+  /// Execution on one of our orders; a full fill frees the side.
+  void on_fill(OrderId id, Qty qty);
+  /// The order left the book without us asking (reject, exchange cancel).
+  void on_order_closed(OrderId id);
+
+  const LiveQuote& bid() const { return live_[0]; }
+  const LiveQuote& ask() const { return live_[1]; }
+  const QuoteStats& stats() const { return stats_; }
+
+private:
+  LiveQuote* find(OrderId id);
+  bool admit(TimestampNs now_ns, int64_t msgs);
+  void charge(TimestampNs now_ns);
+  void cancel(LiveQuote& q, TimestampNs now_ns);
+
+  QuoteManagerOptions options_;
+  LiveQuote live_[2];  // bid, ask
+  OrderId next_id_{1};
+  int64_t interval_ns_{0};  // budget cost of one message
+  TimestampNs tat_ns_{0};   // GCRA theoretical arrival time
+  QuoteStats stats_;
+  OrderCallback order_cb_;
+  ReplaceCallback replace_cb_;
+  CancelCallback cancel_cb_;
+};
+
+} // namespace lumina
@@ -1,14 +1,22 @@
 #pragma once
 
 #include "lumina/types.hpp"
+#include "lumina/wait_strategy.hpp"
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <new>
 
 namespace lumina {
 
 /// Single-Producer Single-Consumer ring buffer (Disruptor-style).
 /// Cache-line padded to avoid false sharing. No locks.
+/// Each side keeps a private copy of the other side's index on its own cache
+/// line and reloads it only when the ring looks full (producer) or empty
+/// (consumer). Besides copying push/pop, the batch calls move a span with a
+/// single index publish, and claim/commit and peek/release let either side
+/// work on a slot in place.
 template <typename T, size_t Size>
 class SPSCRingBuffer {
 public:
@@ -17,23 +25,73 @@ public:
   static constexpr size_t mask = Size - 1;
 
   bool try_push(const T& item) {
-    const size_t w = write_pos_.load(std::memory_order_relaxed);
-    if (w - read_pos_.load(std::memory_order_acquire) >= Size)
-      return false;
-    buffer_[w & mask] = item;
-    write_pos_.store(w + 1, std::memory_order_release);
+    T* slot = claim();
+    if (!slot) return false;
+    *slot = item;
+    commit();
     return true;
   }
 
   bool try_pop(T& item) {
-    const size_t r = read_pos_.load(std::memory_order_relaxed);
-    if (r >= write_pos_.load(std::memory_order_acquire))
-      return false;
-    item = buffer_[r & mask];
-    read_pos_.store(r + 1, std::memory_order_release);
+    const T* slot = peek();
+    if (!slot) return false;
+    item = *slot;
+    release();
     return true;
   }
 
+  /// Push up to n items; returns how many were pushed.
+  size_t try_push_n(const T* items, size_t n) {
+    const size_t w = write_pos_.load(std::memory_order_relaxed);
+    n = std::min(n, free_slots(w, n));
+    if (n == 0) return 0;
+    const size_t first = std::min(n, Size - (w & mask));
+    std::copy_n(items, first, buffer_ + (w & mask));
+    std::copy_n(items + first, n - first, buffer_);
+    write_pos_.store(w + n, std::memory_order_release);
+    return n;
+  }
+
+  /// Pop up to n items into out; returns how many were popped.
+  size_t try_pop_n(T* out, size_t n) {
+    const size_t r = read_pos_.load(std::memory_order_relaxed);
+    n = std::min(n, ready_slots(r, n));
+    if (n == 0) return 0;
+    const size_t first = std::min(n, Size - (r & mask));
+    std::copy_n(buffer_ + (r & mask), first, out);
+    std::copy_n(buffer_, n - first, out + first);
+    read_pos_.store(r + n, std::memory_order_release);
+    return n;
+  }
+
+  /// Producer: next free slot to fill in place, or nullptr if full.
+  /// The slot is published by commit().
+  T* claim() {
+    const size_t w = write_pos_.load(std::memory_order_relaxed);
+    return free_slots(w, 1) ? &buffer_[w & mask] : nullptr;
+  }
+  void commit() {
+    write_pos_.store(write_pos_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+  }
+
+  /// Producer: at least n slots are free. Like claim(), it only reloads the
+  /// consumer index when the cached one shows fewer.
+  bool has_room(size_t n) {
+    return free_slots(write_pos_.load(std::memory_order_relaxed), n) >= n;
+  }
+
+  /// Consumer: oldest unread slot, read in place, or nullptr if empty.
+  /// The slot stays valid until release().
+  const T* peek() {
+    const size_t r = read_pos_.load(std::memory_order_relaxed);
+    return ready_slots(r, 1) ? &buffer_[r & mask] : nullptr;
+  }
+  void release() {
+    read_pos_.store(read_pos_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+  }
+
   size_t size() const {
     return write_pos_.load(std::memory_order_acquire) -
            read_pos_.load(std::memory_order_acquire);
@@ -42,14 +100,41 @@ public:
   bool empty() const { return size() == 0; }
 
 private:
+  // Free slots from w, reloading the consumer index only if fewer than want
+  // are known to be free.
+  size_t free_slots(size_t w, size_t want) {
+    size_t free = Size - (w - read_cache_);
+    if (free < want) {
+      read_cache_ = read_pos_.load(std::memory_order_acquire);
+      free = Size - (w - read_cache_);
+    }
+    return free;
+  }
+
+  size_t ready_slots(size_t r, size_t want) {
+    size_t ready = write_cache_ - r;
+    if (ready < want) {
+      write_cache_ = write_pos_.load(std::memory_order_acquire);
+      ready = write_cache_ - r;
+    }
+    return ready;
+  }
+
   alignas(64) std::atomic<size_t> write_pos_{0};
+  size_t read_cache_{0};   // producer's view of read_pos_
   alignas(64) std::atomic<size_t> read_pos_{0};
-  T buffer_[Size];
+  size_t write_cache_{0};  // consumer's view of write_pos_
+  alignas(64) T buffer_[Size];
 };
 
-/// Multi-Producer Multi-Consumer variant using sequence + CAS.
-/// Slots are pre-allocated; producers claim sequence, consumers claim read.
-template <typename T, size_t Size>
+/// Bounded Multi-Producer Multi-Consumer queue (Vyukov). Every cell carries
+/// a sequence number: seq == pos means free for the producer claiming pos,
+/// seq == pos + 1 means filled for the consumer claiming pos. A position is
+/// only taken by CAS once its cell is in the right state, so a full or empty
+/// queue is detected without touching the shared indices, and no claimed
+/// position is ever abandoned. Use to fan requests from several strategy
+/// threads into one gateway. Wait picks how the blocking push/pop wait.
+template <typename T, size_t Size, typename Wait = SpinYieldWait>
 class MPMCRingBuffer {
 public:
   static_assert((Size & (Size - 1)) == 0, "Size must be power of 2");
@@ -58,52 +143,90 @@ public:
 
   MPMCRingBuffer() {
     for (size_t i = 0; i < Size; ++i)
-      sequences_[i].store(i, std::memory_order_relaxed);
+      cells_[i].seq.store(i, std::memory_order_relaxed);
   }
 
   bool try_push(const T& item) {
-    const size_t pos = write_pos_.fetch_add(1, std::memory_order_acq_rel);
-    if (pos - read_pos_.load(std::memory_order_acquire) >= Size) {
-      write_pos_.fetch_sub(1, std::memory_order_acq_rel);
-      return false;
+    size_t pos = write_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[pos & mask];
+      const size_t seq = cell->seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (write_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false;  // cell still holds the item from one lap ago: full
+      } else {
+        pos = write_pos_.load(std::memory_order_relaxed);
+      }
     }
-    size_t seq;
-    while ((seq = sequences_[pos & mask].load(std::memory_order_acquire)) != pos)
-      ; // spin until slot is free
-    buffer_[pos & mask] = item;
-    sequences_[pos & mask].store(pos + 1, std::memory_order_release);
+    cell->value = item;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    not_empty_.notify();
     return true;
   }
 
   bool try_pop(T& item) {
-    size_t pos = read_pos_.load(std::memory_order_acquire);
+    size_t pos = read_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
     for (;;) {
-      if (pos >= write_pos_.load(std::memory_order_acquire))
-        return false;
-      size_t seq = sequences_[pos & mask].load(std::memory_order_acquire);
-      if (seq == pos + 1) {
-        if (read_pos_.compare_exchange_weak(pos, pos + 1,
-                                            std::memory_order_acq_rel,
-                                            std::memory_order_acquire)) {
-          item = buffer_[pos & mask];
-          sequences_[pos & mask].store(pos + Size, std::memory_order_release);
-          return true;
-        }
-      } else
-        pos = read_pos_.load(std::memory_order_acquire);
+      cell = &cells_[pos & mask];
+      const size_t seq = cell->seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (read_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false;  // not yet filled: empty
+      } else {
+        pos = read_pos_.load(std::memory_order_relaxed);
+      }
     }
+    item = cell->value;
+    cell->seq.store(pos + Size, std::memory_order_release);
+    not_full_.notify();
+    return true;
   }
 
+  /// Blocking variants, waiting according to Wait.
+  void push(const T& item) {
+    for (unsigned attempt = 0;; ++attempt) {
+      const uint32_t token = not_full_.prepare();
+      if (try_push(item)) return;
+      not_full_.wait(token, attempt);
+    }
+  }
+
+  void pop(T& item) {
+    for (unsigned attempt = 0;; ++attempt) {
+      const uint32_t token = not_empty_.prepare();
+      if (try_pop(item)) return;
+      not_empty_.wait(token, attempt);
+    }
+  }
+
+  /// Approximate under concurrent use.
   size_t size() const {
-    return write_pos_.load(std::memory_order_acquire) -
-           read_pos_.load(std::memory_order_acquire);
+    const size_t w = write_pos_.load(std::memory_order_acquire);
+    const size_t r = read_pos_.load(std::memory_order_acquire);
+    return w > r ? w - r : 0;
   }
 
+  bool empty() const { return size() == 0; }
+
 private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
   alignas(64) std::atomic<size_t> write_pos_{0};
   alignas(64) std::atomic<size_t> read_pos_{0};
-  std::atomic<size_t> sequences_[Size];
-  T buffer_[Size];
+  alignas(64) Wait not_empty_;
+  alignas(64) Wait not_full_;
+  alignas(64) Cell cells_[Size];
 };
 
 } // namespace lumina
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/huge_arena.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace lumina {
+
+constexpr size_t DEFAULT_SCRATCH_BYTES = 256 << 10;
+
+/// Monotonic bump arena for results that only live while one event is
+/// processed (fills, depth copies, outgoing FIX text). allocate() is a
+/// pointer bump; reset() at the end of the event frees everything at once.
+/// The buffer is allocated once up front (from a HugeArena if given). If an
+/// event needs more, overflow blocks come from the heap and are released
+/// by the next reset(); overflow_count() makes that visible so the size can
+/// be raised. Single-threaded.
+class ScratchArena {
+public:
+  explicit ScratchArena(size_t bytes = DEFAULT_SCRATCH_BYTES, HugeArena* backing = nullptr)
+    : capacity_(bytes) {
+    if (backing) base_ = static_cast<char*>(backing->allocate(bytes, 64));
+    if (!base_) {
+      owned_.reset(new char[bytes]);
+      base_ = owned_.get();
+    }
+  }
+  ~ScratchArena() { release_overflow(); }
+  ScratchArena(const ScratchArena&) = delete;
+  ScratchArena& operator=(const ScratchArena&) = delete;
+
+  void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+    // Align the address, not the offset: an owned buffer is only
+    // max_align_t aligned.
+    const auto base = reinterpret_cast<uintptr_t>(base_);
+    const size_t offset = ((base + used_ + align - 1) & ~uintptr_t(align - 1)) - base;
+    if (offset <= capacity_ && bytes <= capacity_ - offset) {
+      used_ = offset + bytes;
+      if (used_ > high_water_) high_water_ = used_;
+      return base_ + offset;
+    }
+    return allocate_overflow(bytes, align);
+  }
+
+  /// Uninitialised storage for n trivially destructible Ts.
+  template <typename T>
+  T* allocate_array(size_t n) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /// Invalidate everything allocated since the last reset.
+  void reset() {
+    used_ = 0;
+    if (overflow_) release_overflow();
+  }
+
+  size_t used() const { return used_; }
+  size_t capacity() const { return capacity_; }
+  size_t high_water() const { return high_water_; }
+  /// Heap blocks taken because an event outgrew the buffer (cumulative).
+  size_t overflow_count() const { return overflow_count_; }
+
+private:
+  struct OverflowBlock {
+    OverflowBlock* next;
+    size_t align;
+  };
+
+  void* allocate_overflow(size_t bytes, size_t align) {
+    align = std::max(align, alignof(OverflowBlock));
+    const size_t header = std::max(sizeof(OverflowBlock), align);
+    auto* raw = static_cast<char*>(::operator new(header + bytes, std::align_val_t{align}));
+    overflow_ = new (raw) OverflowBlock{overflow_, align};
+    ++overflow_count_;
+    return raw + header;
+  }
+
+  void release_overflow() {
+    while (overflow_) {
+      OverflowBlock* block = overflow_;
+      overflow_ = block->next;
+      ::operator delete(block, std::align_val_t{block->align});
+    }
+  }
+
+  char* base_{nullptr};
+  std::unique_ptr<char[]> owned_;
+  size_t capacity_;
+  size_t used_{0};
+  size_t high_water_{0};
+  OverflowBlock* overflow_{nullptr};
+  size_t overflow_count_{0};
+};
+
+/// Output sink for trades produced by OrderBook matching. Backed by a
+/// ScratchArena it grows by bump allocation (doubling, old block left to
+/// the arena), so a sweep of any size does no heap allocation; it is then
+/// valid until the arena is reset. Without an arena it grows on the heap,
+/// like a vector, for tests and cold paths.
+class FillSink {
+public:
+  static constexpr size_t DEFAULT_CAPACITY = 64;
+
+  FillSink() = default;
+  explicit FillSink(ScratchArena& arena, size_t initial_capacity = DEFAULT_CAPACITY)
+    : arena_(&arena),
+      data_(arena.allocate_array<Trade>(initial_capacity)),
+      capacity_(initial_capacity) {}
+
+  void push_back(const Trade& t) {
+    if (size_ == capacity_) grow();
+    data_[size_++] = t;
+  }
+
+  void clear() { size_ = 0; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t capacity() const { return capacity_; }
+  const Trade& operator[](size_t i) const { return data_[i]; }
+  const Trade* begin() const { return data_; }
+  const Trade* end() const { return data_ + size_; }
+  const Trade& back() const { return data_[size_ - 1]; }
+
+private:
+  void grow() {
+    const size_t cap = capacity_ ? capacity_ * 2 : DEFAULT_CAPACITY;
+    std::unique_ptr<Trade[]> heap;
+    Trade* next = arena_ ? arena_->allocate_array<Trade>(cap)
+                         : (heap = std::make_unique_for_overwrite<Trade[]>(cap)).get();
+    if (size_) std::memcpy(next, data_, size_ * sizeof(Trade));
+    if (heap) heap_ = std::move(heap);
+    data_ = next;
+    capacity_ = cap;
+  }
+
+  ScratchArena* arena_{nullptr};
+  Trade* data_{nullptr};
+  size_t size_{0};
+  size_t capacity_{0};
+  std::unique_ptr<Trade[]> heap_;
+};
+
+} // namespace lumina
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/thread_utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace lumina {
+
+constexpr char SHM_RING_MAGIC[8] = {'L', 'U', 'M', 'S', 'H', 'M', 'R', '1'};
+constexpr uint32_t SHM_RING_VERSION = 2;
+constexpr uint32_t SHM_MAX_CONSUMERS = 16;
+
+/// Layout at the start of a shared-memory ring region, followed by the
+/// consumer slots and then capacity elements. magic is written last on
+/// initialisation, so a reader that sees it sees a complete header.
+struct ShmRingHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t elem_size;
+  uint64_t capacity;
+  uint32_t max_consumers;
+  std::atomic<int32_t> producer_pid;
+  std::atomic<int64_t> heartbeat_ns;  // monotonic_ns() of the last writer heartbeat
+  alignas(64) std::atomic<uint64_t> write_pos;
+};
+
+/// Per-consumer state kept in the region so a consumer can detach or crash
+/// and resume from where it stopped.
+struct alignas(64) ShmConsumerSlot {
+  std::atomic<uint64_t> cursor;  // next sequence to read
+  std::atomic<uint64_t> lost;    // events overwritten before this consumer read them
+  std::atomic<int32_t> pid;      // attached process, 0 when detached
+  std::atomic<uint32_t> used;    // cursor is meaningful
+  std::atomic<uint32_t> gating;  // try_publish never overwrites what it has not read
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<int64_t>::is_always_lock_free);
+static_assert(std::atomic<int32_t>::is_always_lock_free);
+
+/// A named POSIX shared-memory mapping (shm_open + mmap). Move-only.
+class ShmRegion {
+public:
+  ShmRegion() = default;
+  ~ShmRegion() { close(); }
+  ShmRegion(ShmRegion&& o) noexcept { *this = std::move(o); }
+  ShmRegion& operator=(ShmRegion&& o) noexcept;
+  ShmRegion(const ShmRegion&) = delete;
+  ShmRegion& operator=(const ShmRegion&) = delete;
+
+  /// Open or create name (e.g. "/lumina_md") and size it to bytes. An
+  /// existing region of another size is left alone and create fails:
+  /// resizing it under attached readers would SIGBUS them. Unlink it first.
+  bool create(const std::string& name, size_t bytes);
+  /// Map an existing region at its current size.
+  bool open(const std::string& name);
+  void close();
+  static bool unlink(const std::string& name);
+
+  void* data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  void* data_{nullptr};
+  size_t size_{0};
+};
+
+/// Region size for capacity elements of elem_size (header and consumer
+/// slots included); shm_ring_bytes(0, n) is the offset of the first element.
+size_t shm_ring_bytes(size_t capacity, size_t elem_size);
+
+namespace detail {
+int32_t current_pid();
+bool process_alive(int32_t pid);
+} // namespace detail
+
+/// Producer side of a cross-process multicast ring in shared memory. The
+/// writer never waits on readers. publish() overwrites the ring in sequence,
+/// and a reader that falls a full ring behind detects it and skips ahead;
+/// that keeps the trading process independent of the risk monitor or
+/// research tools attached to it, even if one of them hangs or crashes.
+/// try_publish() instead honours the cursors of gating readers (such as the
+/// recorder) the way SPSCRingBuffer::try_push honours its consumer: it
+/// refuses, rather than overwrite an event one of them has not read, so
+/// with one gating reader the ring is a lossless cross-process SPSC queue.
+/// A gating slot holds the writer back while detached too, so a crashed
+/// recorder resumes without a hole. One writer process per ring.
+template <typename T>
+class ShmRingWriter {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  /// Create the named ring, or re-open it after a producer restart, where
+  /// the sequence continues. Fails on an existing ring of another layout,
+  /// which readers may still have mapped. capacity must be a power of two.
+  bool create(const std::string& name, size_t capacity) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) return false;
+    if (!region_.create(name, shm_ring_bytes(capacity, sizeof(T)))) return false;
+    header_ = static_cast<ShmRingHeader*>(region_.data());
+    const bool initialised = std::memcmp(header_->magic, SHM_RING_MAGIC, 8) == 0;
+    const bool compatible = initialised && header_->version == SHM_RING_VERSION &&
+                            header_->elem_size == sizeof(T) &&
+                            header_->capacity == capacity &&
+                            header_->max_consumers == SHM_MAX_CONSUMERS;
+    if (initialised && !compatible) {
+      region_.close();
+      header_ = nullptr;
+      return false;
+    }
+    if (!initialised) {
+      std::memset(region_.data(), 0, region_.size());
+      header_->version = SHM_RING_VERSION;
+      header_->elem_size = sizeof(T);
+      header_->capacity = capacity;
+      header_->max_consumers = SHM_MAX_CONSUMERS;
+      std::atomic_thread_fence(std::memory_order_release);
+      std::memcpy(header_->magic, SHM_RING_MAGIC, 8);
+    }
+    mask_ = capacity - 1;
+    gate_limit_ = 0;
+    data_ = reinterpret_cast<T*>(static_cast<char*>(region_.data()) +
+                                 shm_ring_bytes(0, sizeof(T)));
+    header_->producer_pid.store(detail::current_pid(), std::memory_order_relaxed);
+    heartbeat();
+    return true;
+  }
+
+  T* claim() { return &data_[header_->write_pos.load(std::memory_order_relaxed) & mask_]; }
+  void publish() {
+    header_->write_pos.store(header_->write_pos.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+  }
+  void publish(const T& item) {
+    *claim() = item;
+    publish();
+  }
+
+  /// Publish n items with one index store.
+  void publish_n(const T* items, size_t n) {
+    const uint64_t w = header_->write_pos.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) data_[(w + i) & mask_] = items[i];
+    header_->write_pos.store(w + n, std::memory_order_release);
+  }
+
+  /// Slot for the next event, or nullptr if writing it would overwrite an
+  /// event a gating reader has not read. Fill it, then publish().
+  T* try_claim() {
+    const uint64_t w = header_->write_pos.load(std::memory_order_relaxed);
+    if (w >= gate_limit_) {
+      gate_limit_ = gate_limit(w);
+      if (w >= gate_limit_) return nullptr;
+    }
+    return &data_[w & mask_];
+  }
+  bool try_publish(const T& item) {
+    T* slot = try_claim();
+    if (!slot) return false;
+    *slot = item;
+    publish();
+    return true;
+  }
+
+  /// Publish as many of n items as gating readers leave room for, with one
+  /// index store. Returns how many were published.
+  size_t try_publish_n(const T* items, size_t n) {
+    const uint64_t w = header_->write_pos.load(std::memory_order_relaxed);
+    if (w + n > gate_limit_) gate_limit_ = gate_limit(w);
+    if (w >= gate_limit_) return 0;
+    n = static_cast<size_t>(std::min<uint64_t>(n, gate_limit_ - w));
+    for (size_t i = 0; i < n; ++i) data_[(w + i) & mask_] = items[i];
+    header_->write_pos.store(w + n, std::memory_order_release);
+    return n;
+  }
+
+  /// Mark the producer alive; call from the event loop (idle or timer).
+  void heartbeat() {
+    header_->heartbeat_ns.store(monotonic_ns(), std::memory_order_release);
+  }
+
+  uint64_t published() const { return header_->write_pos.load(std::memory_order_acquire); }
+  size_t capacity() const { return mask_ + 1; }
+  /// Consumer lag for monitoring (0 for an unused slot).
+  uint64_t lag(uint32_t slot) const {
+    const ShmConsumerSlot& s = slots()[slot];
+    if (!s.used.load(std::memory_order_acquire)) return 0;
+    return published() - s.cursor.load(std::memory_order_acquire);
+  }
+
+private:
+  ShmConsumerSlot* slots() const { return reinterpret_cast<ShmConsumerSlot*>(header_ + 1); }
+
+  /// First sequence try_claim may not write: a ring past the slowest gating
+  /// cursor, or past w when none gates. Cached in gate_limit_ and only
+  /// recomputed when the cached room runs out, like the SPSC producer's
+  /// cached read index. A reader that starts gating later begins at or after
+  /// w (see ShmRingReader::attach), so the cached value stays safe.
+  uint64_t gate_limit(uint64_t w) const {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t slowest = w;
+    for (uint32_t i = 0; i < SHM_MAX_CONSUMERS; ++i) {
+      const ShmConsumerSlot& s = slots()[i];
+      if (s.used.load(std::memory_order_acquire) && s.gating.load(std::memory_order_acquire))
+        slowest = std::min(slowest, s.cursor.load(std::memory_order_acquire));
+    }
+    return slowest + capacity();
+  }
+
+  ShmRegion region_;
+  ShmRingHeader* header_{nullptr};
+  T* data_{nullptr};
+  size_t mask_{0};
+  uint64_t gate_limit_{0};
+};
+
+/// Consumer side. A reader owns one of SHM_MAX_CONSUMERS slots, chosen by
+/// the caller (e.g. recorder = 0, risk monitor = 1). Its cursor lives in the
+/// slot, so detach() and re-attach, or a crash and restart, resume at the
+/// next unread event. Events are copied out and validated after the copy,
+/// so a reader never returns an event the writer was overwriting.
+template <typename T>
+class ShmRingReader {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  ~ShmRingReader() { detach(); }
+
+  /// Attach to slot of the named ring. Fails if the region is missing or
+  /// not initialised, the layout differs, or the slot is held by another
+  /// live process. A never-used slot starts at the current write position.
+  /// gating sets whether the slot holds back try_publish (see
+  /// ShmRingWriter); it stays in force across detach until an attach
+  /// clears it.
+  bool attach(const std::string& name, uint32_t slot, bool gating = false) {
+    if (slot >= SHM_MAX_CONSUMERS || !region_.open(name)) return false;
+    header_ = static_cast<ShmRingHeader*>(region_.data());
+    if (region_.size() < shm_ring_bytes(0, sizeof(T)) ||
+        std::memcmp(header_->magic, SHM_RING_MAGIC, 8) != 0 ||
+        header_->version != SHM_RING_VERSION || header_->elem_size != sizeof(T) ||
+        region_.size() < shm_ring_bytes(header_->capacity, sizeof(T))) {
+      region_.close();
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    ShmConsumerSlot& s = reinterpret_cast<ShmConsumerSlot*>(header_ + 1)[slot];
+    if (!claim_slot(s)) {
+      region_.close();
+      return false;
+    }
+    slot_ = &s;
+    mask_ = header_->capacity - 1;
+    data_ = reinterpret_cast<const T*>(static_cast<char*>(region_.data()) +
+                                       shm_ring_bytes(0, sizeof(T)));
+    const bool fresh = !s.used.load(std::memory_order_acquire);
+    if (fresh) {
+      s.cursor.store(header_->write_pos.load(std::memory_order_acquire),
+                     std::memory_order_relaxed);
+      s.used.store(1, std::memory_order_release);
+    }
+    s.gating.store(gating ? 1 : 0, std::memory_order_release);
+    gating_ = gating;
+    // Pairs with the fence in ShmRingWriter::gate_limit: either the writer
+    // sees this slot gating, or the position read here is one its cached
+    // limit already keeps a full ring ahead of.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (fresh)
+      s.cursor.store(header_->write_pos.load(std::memory_order_acquire),
+                     std::memory_order_release);
+    return true;
+  }
+
+  /// Release the slot; the cursor is kept for the next attach.
+  void detach() {
+    if (!slot_) return;
+    slot_->pid.store(0, std::memory_order_release);
+    slot_ = nullptr;
+    region_.close();
+  }
+
+  bool attached() const { return slot_ != nullptr; }
+
+  /// Copy up to n events in order; returns how many. If the writer has
+  /// lapped this reader, the overwritten events are added to lost() and
+  /// reading continues from the oldest event still in the ring.
+  size_t read(T* out, size_t n) {
+    const uint64_t capacity = mask_ + 1;
+    uint64_t r = slot_->cursor.load(std::memory_order_relaxed);
+    const uint64_t w = header_->write_pos.load(std::memory_order_acquire);
+    uint64_t lost = 0;
+    if (w - r > capacity) {
+      lost = w - capacity - r;
+      r = w - capacity;
+    }
+    n = static_cast<size_t>(std::min<uint64_t>(n, w - r));
+    for (size_t i = 0; i < n; ++i) out[i] = data_[(r + i) & mask_];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // The slot of sequence q is rewritten while write_pos is q + capacity,
+    // so copies of anything below w_after + 1 - capacity may be torn. A
+    // gating cursor keeps try_publish off that slot until it moves on.
+    const uint64_t w_after =
+        header_->write_pos.load(std::memory_order_relaxed) + (gating_ ? 0 : 1);
+    size_t torn = 0;
+    if (w_after > r + capacity)
+      torn = static_cast<size_t>(std::min<uint64_t>(n, w_after - capacity - r));
+    if (torn) std::memmove(out, out + torn, (n - torn) * sizeof(T));
+    if (lost + torn) slot_->lost.fetch_add(lost + torn, std::memory_order_relaxed);
+    slot_->cursor.store(r + n, std::memory_order_release);
+    return n - torn;
+  }
+
+  bool try_read(T& out) { return read(&out, 1) == 1; }
+
+  uint64_t cursor() const { return slot_->cursor.load(std::memory_order_relaxed); }
+  uint64_t lost() const { return slot_->lost.load(std::memory_order_relaxed); }
+  uint64_t available() const {
+    return header_->write_pos.load(std::memory_order_acquire) - cursor();
+  }
+  TimestampNs producer_heartbeat_ns() const {
+    return header_->heartbeat_ns.load(std::memory_order_acquire);
+  }
+  bool producer_alive(TimestampNs max_age_ns) const {
+    return monotonic_ns() - producer_heartbeat_ns() <= max_age_ns;
+  }
+
+private:
+  static bool claim_slot(ShmConsumerSlot& s);
+
+  ShmRegion region_;
+  ShmRingHeader* header_{nullptr};
+  ShmConsumerSlot* slot_{nullptr};
+  const T* data_{nullptr};
+  size_t mask_{0};
+  bool gating_{false};
+};
+
+/// A slot can be taken if it is free, already ours, or held by a process
+/// that no longer exists (a crashed consumer).
+template <typename T>
+bool ShmRingReader<T>::claim_slot(ShmConsumerSlot& s) {
+  const int32_t self = detail::current_pid();
+  int32_t holder = s.pid.load(std::memory_order_acquire);
+  for (;;) {
+    if (holder != 0 && holder != self && detail::process_alive(holder)) return false;
+    if (s.pid.compare_exchange_weak(holder, self, std::memory_order_acq_rel)) return true;
+  }
+}
+
+} // namespace lumina
@@ -6,6 +6,9 @@
 #include "lumina/ring_buffer.hpp"
 #include "lumina/risk_checks.hpp"
 #include "lumina/market_data_handler.hpp"
+#include "lumina/quote_manager.hpp"
+#include "lumina/scratch_arena.hpp"
+#include "lumina/volatility.hpp"
 #include <memory>
 #include <atomic>
 #include <functional>
@@ -15,7 +18,8 @@ namespace lumina {
 constexpr size_t STRATEGY_RING_SIZE = 65536;
 
 /// Reads MarketDataEvent from ring, runs Avellaneda-Stoikov + OBI,
-/// and emits quote decisions (subject to pre-trade risk).
+/// and keeps a two-sided quote (subject to pre-trade risk) through a
+/// QuoteManager, which only sends what changed.
 class StrategyEngine {
 public:
   using MDRing = MarketDataHandler::MDRing;
@@ -24,29 +28,85 @@ public:
                  double gamma, double sigma, double T_seconds,
                  PreTradeRisk& risk);
 
-  /// Process one event from the ring (call in tight loop).
+  /// Process the events in the ring, then the conflated book state if the
+  /// handler parked a newer one (call in tight loop).
   void poll();
 
-  /// Callback when strategy wants to send/cancel orders.
-  using OrderCallback = std::function<void(OrderId, Price, Qty, Side, bool is_bid)>;
-  using CancelCallback = std::function<void(OrderId)>;
-  void set_order_callback(OrderCallback cb) { order_cb_ = std::move(cb); }
-  void set_cancel_callback(CancelCallback cb) { cancel_cb_ = std::move(cb); }
+  /// Slot the handler conflates into (MarketDataHandler::set_conflation).
+  void set_conflation(std::shared_ptr<ConflationSlot> slot) { conflation_ = std::move(slot); }
+  /// Events handled by on_event.
+  uint64_t events() const { return events_; }
+  /// Book events merged away or superseded in the conflation slot.
+  uint64_t conflated_events() const { return conflated_; }
+  /// Events never seen that were not conflated: lost to a full ring.
+  uint64_t dropped_events() const {
+    const uint64_t seen = events_ + conflated_;
+    return last_seq_ > seen ? last_seq_ - seen : 0;
+  }
+
+  /// Outbound orders: new, cancel/replace and cancel, with ids assigned
+  /// by the quote manager.
+  using OrderCallback = QuoteManager::OrderCallback;
+  using ReplaceCallback = QuoteManager::ReplaceCallback;
+  using CancelCallback = QuoteManager::CancelCallback;
+  void set_order_callback(OrderCallback cb) { quotes_.set_order_callback(std::move(cb)); }
+  void set_replace_callback(ReplaceCallback cb) { quotes_.set_replace_callback(std::move(cb)); }
+  void set_cancel_callback(CancelCallback cb) { quotes_.set_cancel_callback(std::move(cb)); }
+
+  /// Quote size, requote threshold and message budget.
+  void set_quote_options(const QuoteManagerOptions& options) { quotes_.set_options(options); }
+  void set_quote_qty(Qty qty) { quote_qty_ = qty; }
+  /// Live orders and outbound message counts; feed fills and unsolicited
+  /// cancels back through it.
+  QuoteManager& quotes() { return quotes_; }
+  const QuoteManager& quotes() const { return quotes_; }
+
+  /// Per-event scratch for variable-length results (fills, depth copies,
+  /// outgoing FIX text). Reset after every event poll() handles, so nothing
+  /// allocated from it may be kept past the callback that produced it.
+  ScratchArena& scratch() { return scratch_; }
+
+  /// Online volatility of mid returns. Once it is ready, every event sets
+  /// the model's sigma to its estimate in price units per sqrt(second)
+  /// (per-second stdev of log returns times mid), which the AS spread
+  /// term gamma * sigma^2 * (T - t) turns into wider or tighter quotes;
+  /// until then the constructor's sigma stands. Clears the history.
+  /// t runs from the first event's timestamp and the horizon rolls over
+  /// every T seconds, so the term holds on any clock and any feed length.
+  void set_vol_options(const VolOptions& options) { vol_.set_options(options); }
+  const VolatilityEstimator& volatility() const { return vol_; }
+  double sigma() const { return as_.sigma(); }
 
   void set_k(double k) { k_ = k; }
   double reservation_price() const { return last_r_; }
   double obi_signal() const { return obi_.value(); }
+  /// Price of the last trade event (0 before the first).
+  Price last_trade_price() const { return last_trade_price_; }
 
 private:
+  void handle(const MarketDataEvent& ev);
+  void on_event(const MarketDataEvent& ev);
+  void requote(const MarketDataEvent& ev);
+  /// Seconds into the current AS horizon at ts.
+  double horizon_time(TimestampNs ts);
+
   std::shared_ptr<MDRing> from_md_;
+  std::shared_ptr<ConflationSlot> conflation_;
+  uint64_t last_seq_{0};  // highest handler seq handled
+  uint64_t events_{0};
+  uint64_t conflated_{0};
   AvellanedaStoikov as_;
+  VolatilityEstimator vol_;
   OBISignal obi_;
   PreTradeRisk& risk_;
   double k_{1.5};
   double last_r_{0.0};
-  double session_start_ns_{0.0};
-  OrderCallback order_cb_;
-  CancelCallback cancel_cb_;
+  Price last_trade_price_{0};
+  TimestampNs session_start_ns_{0};  // start of the current AS horizon
+  bool session_started_{false};
+  Qty quote_qty_{100};
+  QuoteManager quotes_;
+  ScratchArena scratch_;
 };
 
 } // namespace lumina
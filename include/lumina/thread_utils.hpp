@@ -1,6 +1,8 @@
 #pragma once
 
+#include "lumina/types.hpp"
 #include <pthread.h>
+#include <time.h>
 #include <vector>
 #include <cstdint>
 
@@ -34,4 +36,11 @@ inline bool pin_thread_to_cores(const std::vector<uint32_t>& core_ids) {
 #endif
 }
 
+/// CLOCK_MONOTONIC in nanoseconds; comparable across processes on one host.
+inline TimestampNs monotonic_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<TimestampNs>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
 } // namespace lumina
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/wait_strategy.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace lumina {
+
+/// Consistent top-of-book quote as seen by readers of TopOfBookCell.
+struct TopOfBook {
+  Price bid{0};
+  Price ask{0};
+  Qty bid_qty{0};
+  Qty ask_qty{0};
+  Price mid{0};
+  Qty bid_volume{0};
+  Qty ask_volume{0};
+  uint64_t seq{0};  // publish count; 0 = nothing published yet
+  TimestampNs ts_ns{0};
+};
+
+/// Single-writer, many-reader top of book in one cache line, published
+/// behind a seqlock. The writer never waits; readers retry only if they
+/// overlap a publish. The seqlock counter doubles as the sequence number
+/// (two increments per publish) and mid is derived on read, which keeps the
+/// record at 64 bytes. Fields are relaxed atomics so concurrent reads are
+/// well-defined; the fences order them against the counter.
+class alignas(64) TopOfBookCell {
+public:
+  /// Writer thread only. top.seq and top.mid are ignored.
+  void publish(const TopOfBook& top) {
+    const uint64_t v = version_.load(std::memory_order_relaxed);
+    version_.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bid_.store(top.bid, std::memory_order_relaxed);
+    ask_.store(top.ask, std::memory_order_relaxed);
+    bid_qty_.store(top.bid_qty, std::memory_order_relaxed);
+    ask_qty_.store(top.ask_qty, std::memory_order_relaxed);
+    bid_volume_.store(top.bid_volume, std::memory_order_relaxed);
+    ask_volume_.store(top.ask_volume, std::memory_order_relaxed);
+    ts_ns_.store(top.ts_ns, std::memory_order_relaxed);
+    version_.store(v + 2, std::memory_order_release);
+  }
+
+  /// Single attempt; false if a publish was in flight.
+  bool try_read(TopOfBook& out) const {
+    const uint64_t v = version_.load(std::memory_order_acquire);
+    if (v & 1) return false;
+    out.bid = bid_.load(std::memory_order_relaxed);
+    out.ask = ask_.load(std::memory_order_relaxed);
+    out.bid_qty = bid_qty_.load(std::memory_order_relaxed);
+    out.ask_qty = ask_qty_.load(std::memory_order_relaxed);
+    out.bid_volume = bid_volume_.load(std::memory_order_relaxed);
+    out.ask_volume = ask_volume_.load(std::memory_order_relaxed);
+    out.ts_ns = ts_ns_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) != v) return false;
+    out.mid = quote_mid(out.bid, out.ask);
+    out.seq = v / 2;
+    return true;
+  }
+
+  /// Spin until a consistent copy is read.
+  TopOfBook read() const {
+    TopOfBook out;
+    while (!try_read(out)) cpu_relax();
+    return out;
+  }
+
+  uint64_t seq() const { return version_.load(std::memory_order_acquire) / 2; }
+
+private:
+  std::atomic<uint64_t> version_{0};  // odd while a publish is in flight
+  std::atomic<Price> bid_{0};
+  std::atomic<Price> ask_{0};
+  std::atomic<Qty> bid_qty_{0};
+  std::atomic<Qty> ask_qty_{0};
+  std::atomic<Qty> bid_volume_{0};
+  std::atomic<Qty> ask_volume_{0};
+  std::atomic<TimestampNs> ts_ns_{0};
+};
+static_assert(sizeof(TopOfBookCell) == 64);
+
+} // namespace lumina
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <cstddef>
 
@@ -9,14 +10,39 @@ using Price = int64_t;   // fixed-point or integer cents
 using Qty = int64_t;
 using OrderId = uint64_t;
 using TimestampNs = int64_t;
+using SymbolId = uint32_t;  // dense id assigned by SymbolTable
+
+constexpr SymbolId INVALID_SYMBOL = static_cast<SymbolId>(-1);
 
 enum class Side : uint8_t { Buy, Sell };
 
+enum class TimeInForce : uint8_t {
+  GTC,  // rest any remainder
+  IOC,  // fill what crosses now, cancel the rest
+  FOK,  // fill completely now or reject
+};
+
+/// Outcome of a limit order sent through the matching engine.
+enum class ExecStatus : uint8_t {
+  Rested,           // no fill, full quantity resting
+  PartiallyFilled,  // some fills, remainder resting
+  Filled,           // fully filled
+  Cancelled,        // IOC remainder (or unrestable remainder) cancelled
+  Rejected,         // bad qty, duplicate id, FOK not fillable, post-only would cross
+};
+
+struct ExecReport {
+  ExecStatus status{ExecStatus::Rejected};
+  Qty filled_qty{0};
+  Qty leaves_qty{0};
+};
+
 struct Order {
   OrderId id{0};
   Price price{0};
   Qty qty{0};
   Side side{Side::Buy};
+  bool post_only{false};  // rested as post-only; a modify may not make it take
   TimestampNs created_ns{0};
   void* pool_node{nullptr};  // for memory pool reuse
 };
@@ -35,6 +61,21 @@ struct BookLevel {
   int count{0};
 };
 
+/// Caller-owned top-of-book depth in structure-of-arrays layout (best level
+/// first), filled by OrderBook::snapshot_depth without allocation.
+template <size_t N>
+struct DepthSnapshot {
+  static constexpr size_t capacity = N;
+  std::array<Price, N> bid_price{};
+  std::array<Qty, N> bid_qty{};
+  std::array<int, N> bid_count{};
+  std::array<Price, N> ask_price{};
+  std::array<Qty, N> ask_qty{};
+  std::array<int, N> ask_count{};
+  size_t bid_levels{0};
+  size_t ask_levels{0};
+};
+
 // Market data event for ring buffer
 enum class MDFlag : uint8_t {
   None,
@@ -43,17 +84,72 @@ enum class MDFlag : uint8_t {
   BestBidAsk,
 };
 
+/// Mid with the same one-sided rules as OrderBook::mid_price.
+inline Price quote_mid(Price bid, Price ask) {
+  if (bid == 0) return ask;
+  if (ask == 0) return bid;
+  return (bid + ask) / 2;
+}
+
+/// Quantity as carried in a MarketDataEvent: 32 bits, saturating. Feed
+/// order sizes are 32-bit already; only side totals can get near the limit.
+using EventQty = int32_t;
+
+constexpr EventQty to_event_qty(Qty q) {
+  if (q > INT32_MAX) return INT32_MAX;
+  if (q < -INT32_MAX) return -INT32_MAX;
+  return static_cast<EventQty>(q);
+}
+
+constexpr EventQty NO_LEVEL = -1;
+
+/// MDFlag::Trade payload.
+struct TradeTick {
+  Price price;
+  EventQty qty;
+  EventQty level_qty;  // left at price on ev.side if it executed a resting order, else NO_LEVEL
+};
+
+/// MDFlag::BookUpdate payload: net change at one level.
+struct LevelTick {
+  Price price;
+  EventQty delta;      // signed qty change at price on ev.side
+  EventQty level_qty;  // qty left at price (0: level removed)
+};
+
+/// MDFlag::BestBidAsk payload: best-level sizes, for events that stand for
+/// a book state rather than one change (conflated updates).
+struct TopTick {
+  EventQty bid_qty;
+  EventQty ask_qty;
+  int64_t reserved;
+};
+
+/// Handler output, one cache line per ring slot. Every event carries the
+/// handler sequence number (TopOfBook::seq of that state; a gap means
+/// events were conflated or dropped), the best prices and the side totals
+/// after the update. flag selects the payload. Best-level sizes do not fit
+/// the line: they are on the handler's TopOfBookCell (same seq), and in the
+/// TopTick of a conflated state.
 struct MarketDataEvent {
-  MDFlag flag{MDFlag::None};
+  uint64_t seq{0};
   TimestampNs ts_ns{0};
-  Price mid{0};
   Price bid{0};
   Price ask{0};
-  Qty bid_qty{0};
-  Qty ask_qty{0};
-  Qty bid_volume{0};  // total volume on bid side (for OBI)
-  Qty ask_volume{0};  // total volume on ask side
-  Trade last_trade{};
+  MDFlag flag{MDFlag::None};
+  Side side{Side::Buy};   // side of the changed level
+  uint16_t reserved{0};
+  uint32_t conflated{0};  // book events merged into this one (conflation mode)
+  EventQty bid_volume{0}; // total volume on bid side (for OBI)
+  EventQty ask_volume{0}; // total volume on ask side
+  union {
+    TradeTick trade{};
+    LevelTick level;
+    TopTick top;
+  };
+
+  Price mid() const { return quote_mid(bid, ask); }
 };
+static_assert(sizeof(MarketDataEvent) == 64);
 
 } // namespace lumina
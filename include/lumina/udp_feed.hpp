@@ -0,0 +1,161 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include "lumina/feed_source.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lumina {
+
+/// Wire format of the UDP feed, MoldUDP64-style: a FeedPacketHeader, then
+/// count capture records (itch_format.hpp) whose sequence numbers run from
+/// seq. A and B lines carry identical packets.
+struct FeedPacketHeader {
+  uint64_t seq;       // sequence number of the first record
+  uint16_t count;
+  uint16_t reserved0;
+  uint32_t reserved1;
+};
+static_assert(sizeof(FeedPacketHeader) == 16);
+
+constexpr size_t FEED_MAX_PAYLOAD = 1472;  // one 1500-byte MTU frame
+constexpr size_t FEED_RECV_BUFFER = 2048;  // room to spot oversized datagrams
+
+/// One feed line. A multicast group is joined on the interface address; a
+/// unicast address is simply bound (handy where multicast is unavailable).
+struct UdpLine {
+  std::string group;
+  uint16_t port{0};                // 0: line not used
+  std::string iface{"0.0.0.0"};    // local interface address
+};
+
+struct UdpFeedOptions {
+  UdpLine a;
+  UdpLine b;
+  uint64_t first_seq{0};            // first expected seq; 0 syncs to the first packet
+  size_t reorder_window{64};        // packets held while waiting for a gap to fill
+  int64_t gap_timeout_ns{500'000};  // give up on a gap after this long
+  size_t recv_batch{32};            // datagrams per recvmmsg call
+  int rcvbuf_bytes{4 << 20};        // SO_RCVBUF request
+};
+
+/// Counters, kept on the polling thread (read them there or after it stops).
+struct UdpFeedStats {
+  std::array<uint64_t, 2> packets{};  // datagrams received on A, B
+  std::array<uint64_t, 2> first{};    // packets a line delivered before the other
+  uint64_t messages{0};               // messages delivered in sequence
+  uint64_t duplicates{0};             // copies of packets already delivered
+  uint64_t reordered{0};              // packets delivered from the reorder window
+  uint64_t gaps{0};                   // gaps given up on (recovery callbacks)
+  uint64_t gap_messages{0};           // messages lost in those gaps
+  uint64_t late{0};                   // packets that arrived after their gap was given up
+  uint64_t malformed{0};              // short, truncated, oversized or damaged datagrams (refused)
+};
+
+/// FeedSource over a pair of redundant UDP lines. Each poll drains both
+/// sockets with recvmmsg and arbitrates on sequence number: whichever copy
+/// of a packet arrives first is delivered, the other is counted as a
+/// duplicate. A copy whose records are damaged or fewer than its count is
+/// refused (malformed), leaving the other line to fill that sequence range.
+/// A packet ahead of the expected sequence waits in a bounded
+/// reorder window for the other line (or a late packet) to fill the gap.
+/// When the window is full or the gap outlives gap_timeout_ns the gap is
+/// given up: the recovery callback gets the missing range and delivery
+/// resumes at the oldest held packet.
+class UdpFeedSource : public FeedSource {
+public:
+  /// Missing messages [from_seq, to_seq), e.g. to request a retransmission
+  /// or a snapshot refresh.
+  using RecoveryCallback = std::function<void(uint64_t from_seq, uint64_t to_seq)>;
+
+  UdpFeedSource() = default;
+  ~UdpFeedSource() override { close(); }
+  UdpFeedSource(const UdpFeedSource&) = delete;
+  UdpFeedSource& operator=(const UdpFeedSource&) = delete;
+
+  bool open(const UdpFeedOptions& options);
+  void close();
+  void set_recovery_callback(RecoveryCallback cb) { recovery_cb_ = std::move(cb); }
+
+  size_t poll(FeedMessage* out, size_t max) override;
+
+  /// Sequence number of the next message to deliver.
+  uint64_t next_seq() const { return next_seq_; }
+  const UdpFeedStats& stats() const { return stats_; }
+
+private:
+  struct Pending {
+    uint64_t seq{0};
+    uint16_t count{0};
+    uint8_t line{0};
+    bool used{false};
+    size_t bytes{0};
+    std::vector<uint64_t> data;  // 8-byte aligned packet copy
+  };
+  struct Range {
+    uint64_t from{0};
+    uint64_t to{0};
+  };
+  static constexpr size_t SKIPPED_RANGES = 16;
+
+  void receive(int line);
+  void on_packet(int line, const char* data, size_t bytes);
+  void deliver(int line, const char* records, size_t bytes, uint64_t seq, uint16_t count);
+  void drain_pending();
+  void give_up_gap();
+  Pending* oldest_pending();
+  bool in_skipped(uint64_t seq, uint64_t end) const;
+
+  UdpFeedOptions options_;
+  std::array<int, 2> fds_{-1, -1};
+  std::vector<uint64_t> recv_buf_;  // recv_batch x FEED_RECV_BUFFER, 8-byte aligned
+  std::vector<Pending> pending_;
+  size_t pending_count_{0};
+  TimestampNs gap_since_ns_{0};
+  std::vector<FeedMessage> staged_;  // decoded, not yet handed out
+  size_t staged_head_{0};
+  size_t staged_tail_{0};
+  uint64_t next_seq_{0};
+  bool synced_{false};
+  std::array<Range, SKIPPED_RANGES> skipped_{};
+  size_t skipped_next_{0};
+  UdpFeedStats stats_;
+  RecoveryCallback recovery_cb_;
+};
+
+/// Sends packets of capture records on an A/B line pair: the local
+/// publisher used by tests and for replaying captures onto a network.
+class UdpFeedPublisher {
+public:
+  UdpFeedPublisher() = default;
+  ~UdpFeedPublisher() { close(); }
+  UdpFeedPublisher(const UdpFeedPublisher&) = delete;
+  UdpFeedPublisher& operator=(const UdpFeedPublisher&) = delete;
+
+  /// b.port 0 publishes on A only. Multicast leaves through each line's
+  /// iface with loopback on, so a receiver on the same host sees it.
+  bool open(const UdpLine& a, const UdpLine& b = {});
+  void close();
+
+  /// One packet of count records [seq, seq + count) on line 0 (A) or 1 (B).
+  bool send(int line, uint64_t seq, uint16_t count, const char* records, size_t bytes);
+
+  /// Cut a capture (file header included) into packets of up to
+  /// max_per_packet records and send each on every open line, paced to
+  /// msgs_per_sec (0: as fast as possible). Stops at a record the decoder
+  /// would refuse or one too large for a packet. Returns messages sent.
+  uint64_t replay(const char* capture, size_t size, double msgs_per_sec = 0,
+                  size_t max_per_packet = 32);
+
+private:
+  std::array<int, 2> fds_{-1, -1};
+  std::array<uint32_t, 2> addr_{};  // destination per line, network byte order
+  std::array<uint16_t, 2> port_{};
+};
+
+} // namespace lumina
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "lumina/types.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace lumina {
+
+constexpr size_t MAX_VOL_WINDOW = 1024;
+
+enum class VolModel : uint8_t {
+  Rolling,    // equal weights over the last window returns
+  Ewma,       // exponential weights per event
+  TimeDecay,  // exponential weights in event time
+};
+
+struct VolOptions {
+  VolModel model{VolModel::Rolling};
+  size_t window{256};               // Rolling: returns kept, up to MAX_VOL_WINDOW
+  double alpha{0.05};               // Ewma: weight of the newest return
+  double half_life_ns{1e9};         // TimeDecay: old returns weigh half after this long
+  size_t min_samples{16};           // returns seen before the estimate is used
+};
+
+/// Streaming volatility of mid log returns, O(1) per update with no
+/// allocation and no rescans. A return is taken each time the mid moves,
+/// so events that leave it unchanged (trades, deep-book updates) add time
+/// but no zero returns. Rolling is Welford's update with the oldest return
+/// swapped out of a fixed ring; it matches variance_simd (population
+/// variance) over the same window up to rounding. Ewma and TimeDecay keep
+/// a weighted mean and second moment; TimeDecay discounts both by
+/// 2^(-dt / half_life) before adding each return, so bursts of moves at
+/// one timestamp count fully and quiet stretches age the estimate out.
+/// Each model also averages the time between moves with the same weights,
+/// which turns the per-move variance into a per-second one.
+class VolatilityEstimator {
+public:
+  explicit VolatilityEstimator(VolOptions options = {}) { set_options(options); }
+
+  /// Clears the history.
+  void set_options(const VolOptions& options) {
+    options_ = options;
+    options_.window = std::clamp<size_t>(options_.window, 2, MAX_VOL_WINDOW);
+    options_.alpha = std::clamp(options_.alpha, 1e-6, 1.0);
+    reset();
+  }
+
+  void reset() {
+    last_mid_ = 0;
+    last_ts_ = 0;
+    samples_ = 0;
+    head_ = 0;
+    count_ = 0;
+    sum_dt_ = 0;
+    mean_dt_ = 0.0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+    weight_ = 0.0;
+  }
+
+  /// Add the return since the previous mid, if it moved. Non-positive
+  /// mids are skipped.
+  void update(Price mid, TimestampNs ts_ns) {
+    if (mid <= 0 || mid == last_mid_) return;
+    if (last_mid_ > 0) {
+      const TimestampNs dt = std::max<TimestampNs>(ts_ns - last_ts_, 0);
+      add(std::log(static_cast<double>(mid) / static_cast<double>(last_mid_)), dt);
+      ++samples_;
+    }
+    last_mid_ = mid;
+    last_ts_ = ts_ns;
+  }
+
+  /// Variance of one return (population, per mid move).
+  double variance() const {
+    switch (options_.model) {
+    case VolModel::Rolling:
+      return count_ ? std::max(m2_, 0.0) / static_cast<double>(count_) : 0.0;
+    case VolModel::Ewma:
+      return m2_;
+    case VolModel::TimeDecay:
+      return weight_ > 0.0 ? std::max(m2_, 0.0) / weight_ : 0.0;
+    }
+    return 0.0;
+  }
+  double sigma() const { return std::sqrt(variance()); }
+  /// Mean time between mid moves, weighted like the returns.
+  double mean_dt_ns() const {
+    switch (options_.model) {
+    case VolModel::Rolling:
+      return count_ ? static_cast<double>(sum_dt_) / static_cast<double>(count_) : 0.0;
+    case VolModel::Ewma:
+      return mean_dt_;
+    case VolModel::TimeDecay:
+      return weight_ > 0.0 ? mean_dt_ / weight_ : 0.0;
+    }
+    return 0.0;
+  }
+  /// Variance of log returns per second: variance per move over the mean
+  /// time per move. 0 until the returns span some time.
+  double variance_per_sec() const {
+    const double dt = mean_dt_ns();
+    return dt > 0.0 ? variance() * 1e9 / dt : 0.0;
+  }
+  double sigma_per_sec() const { return std::sqrt(variance_per_sec()); }
+  double mean() const { return mean_; }
+  /// Returns seen since the last reset.
+  uint64_t samples() const { return samples_; }
+  /// Enough returns, spread over some time, for a per-second estimate.
+  bool ready() const { return samples_ >= options_.min_samples && mean_dt_ns() > 0.0; }
+  const VolOptions& options() const { return options_; }
+
+private:
+  void add(double r, TimestampNs dt_ns) {
+    switch (options_.model) {
+    case VolModel::Rolling: {
+      if (count_ < options_.window) {
+        ++count_;
+        sum_dt_ += dt_ns;
+        const double d = r - mean_;
+        mean_ += d / static_cast<double>(count_);
+        m2_ += d * (r - mean_);
+      } else {
+        const double old = ring_[head_];
+        const double old_mean = mean_;
+        mean_ += (r - old) / static_cast<double>(count_);
+        m2_ += (r - old) * (r - mean_ + old - old_mean);
+        sum_dt_ += dt_ns - dt_ring_[head_];
+      }
+      ring_[head_] = r;
+      dt_ring_[head_] = dt_ns;
+      head_ = head_ + 1 == options_.window ? 0 : head_ + 1;
+      return;
+    }
+    case VolModel::Ewma: {
+      // West's weighted update; m2_ holds the variance itself.
+      if (samples_ == 0) {
+        mean_ = r;
+        mean_dt_ = static_cast<double>(dt_ns);
+        return;
+      }
+      const double a = options_.alpha;
+      mean_dt_ += a * (static_cast<double>(dt_ns) - mean_dt_);
+      const double d = r - mean_;
+      mean_ += a * d;
+      m2_ = (1.0 - a) * (m2_ + a * d * d);
+      return;
+    }
+    case VolModel::TimeDecay: {
+      const double dt = static_cast<double>(dt_ns);
+      const double decay = std::exp2(-dt / options_.half_life_ns);
+      weight_ = weight_ * decay + 1.0;
+      mean_dt_ = mean_dt_ * decay + dt;
+      m2_ *= decay;
+      const double d = r - mean_;
+      mean_ += d / weight_;
+      m2_ += d * (r - mean_);
+      return;
+    }
+    }
+  }
+
+  VolOptions options_;
+  Price last_mid_{0};
+  TimestampNs last_ts_{0};
+  uint64_t samples_{0};
+  size_t head_{0};
+  size_t count_{0};
+  double mean_{0.0};
+  double m2_{0.0};       // sum of squared deviations (Rolling, TimeDecay) or variance (Ewma)
+  double weight_{0.0};   // TimeDecay: sum of decayed weights
+  int64_t sum_dt_{0};    // Rolling: time spanned by the window
+  double mean_dt_{0.0};  // Ewma: mean dt; TimeDecay: decayed sum of dt
+  std::array<double, MAX_VOL_WINDOW> ring_{};
+  std::array<int64_t, MAX_VOL_WINDOW> dt_ring_{};
+};
+
+} // namespace lumina
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lumina {
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+/// Wait strategies for blocking queue operations. A waiter takes a token
+/// with prepare(), re-checks its condition, then calls wait(token, attempt)
+/// with attempt counting up from 0 until the condition holds. The other
+/// side calls notify() after every change that could satisfy a waiter.
+
+/// Burn the core: lowest latency, needs a dedicated core per waiter.
+struct BusySpinWait {
+  uint32_t prepare() const { return 0; }
+  void wait(uint32_t, unsigned) const { cpu_relax(); }
+  void notify() {}
+};
+
+/// Spin for a while, then give the core away with sched_yield.
+struct SpinYieldWait {
+  static constexpr unsigned SPIN_LIMIT = 128;
+  uint32_t prepare() const { return 0; }
+  void wait(uint32_t, unsigned attempt) const {
+    if (attempt < SPIN_LIMIT) cpu_relax();
+    else std::this_thread::yield();
+  }
+  void notify() {}
+};
+
+/// Spin briefly, then sleep in the kernel on a futex until notified. notify()
+/// bumps an epoch every time (so a waiter that read an older epoch never
+/// sleeps through it) but only makes the wake syscall if someone is asleep.
+class FutexWait {
+public:
+  static constexpr unsigned SPIN_LIMIT = 64;
+
+  uint32_t prepare() const { return epoch_.load(std::memory_order_acquire); }
+
+  void wait(uint32_t token, unsigned attempt) {
+    if (attempt < SPIN_LIMIT) {
+      cpu_relax();
+      return;
+    }
+#ifdef __linux__
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE,
+            token, nullptr, nullptr, 0);
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+#else
+    (void)token;
+    std::this_thread::yield();
+#endif
+  }
+
+  void notify() {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+    if (sleepers_.load(std::memory_order_seq_cst) > 0)
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE,
+              INT_MAX, nullptr, nullptr, 0);
+#endif
+  }
+
+private:
+  alignas(64) std::atomic<uint32_t> epoch_{0};
+  std::atomic<uint32_t> sleepers_{0};
+};
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+/// Backoff for a polling loop whose last pass found no work. idle(n) gets
+/// the number of consecutive empty passes (0 after any work): the first
+/// `spins` return at once, the next `pauses` issue a pause instruction, the
+/// next `yields` call sched_yield, and after that the thread sleeps, from
+/// min_sleep_ns doubling up to max_sleep_ns (max_sleep_ns 0 keeps yielding).
+/// A phase of FOREVER passes never ends, however long the feed stays quiet.
+struct IdleStrategy {
+  static constexpr uint64_t FOREVER = UINT64_MAX;
+  enum class Phase : uint8_t { Spin, Pause, Yield, Sleep };
+
+  uint64_t spins{0};
+  uint64_t pauses{1024};
+  uint64_t yields{64};
+  int64_t min_sleep_ns{1'000};
+  int64_t max_sleep_ns{100'000};
+
+  /// Hot-spin forever: lowest wake-up latency, owns the core.
+  static constexpr IdleStrategy busy_spin() { return {FOREVER, 0, 0, 0, 0}; }
+  /// Spin with pause forever: same latency, kinder to a hyperthread sibling.
+  static constexpr IdleStrategy pause_spin() { return {0, FOREVER, 0, 0, 0}; }
+  /// Spin briefly, then yield the core on every empty pass.
+  static constexpr IdleStrategy spin_yield() { return {0, 1024, FOREVER, 0, 0}; }
+
+  /// What idle(n) does after n empty passes; n is past the spins and
+  /// pauses on return so Sleep can size the backoff.
+  constexpr Phase phase(uint64_t& n) const {
+    if (spins == FOREVER || n < spins) return Phase::Spin;
+    n -= spins;
+    if (pauses == FOREVER || n < pauses) return Phase::Pause;
+    n -= pauses;
+    if (yields == FOREVER || n < yields || max_sleep_ns <= 0) return Phase::Yield;
+    n -= yields;
+    return Phase::Sleep;
+  }
+
+  void idle(uint64_t n) const {
+    switch (phase(n)) {
+    case Phase::Spin:
+      return;
+    case Phase::Pause:
+      cpu_relax();
+      return;
+    case Phase::Yield:
+      std::this_thread::yield();
+      return;
+    case Phase::Sleep:
+      break;
+    }
+    const int64_t ns = std::min(max_sleep_ns, min_sleep_ns << std::min<uint64_t>(n, 20));
+    std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+  }
+};
+
+} // namespace lumina
@@ -0,0 +1,84 @@
+#include "lumina/book_manager.hpp"
+#include "lumina/thread_utils.hpp"
+#include <stdexcept>
+
+namespace lumina {
+
+SymbolId SymbolTable::intern(std::string_view symbol) {
+  auto it = ids_.find(symbol);
+  if (it != ids_.end()) return it->second;
+  if (symbol.size() >= SYMBOL_LEN)
+    throw std::invalid_argument("symbol longer than SYMBOL_LEN - 1");
+  const SymbolId id = static_cast<SymbolId>(names_.size());
+  names_.emplace_back(symbol);
+  ids_.emplace(names_.back(), id);
+  return id;
+}
+
+SymbolId SymbolTable::find(std::string_view symbol) const {
+  auto it = ids_.find(symbol);
+  return it == ids_.end() ? INVALID_SYMBOL : it->second;
+}
+
+std::string_view SymbolTable::name(SymbolId id) const {
+  return id < names_.size() ? std::string_view(names_[id]) : std::string_view();
+}
+
+BookManager::BookManager(std::vector<uint32_t> shard_cores, size_t max_orders_per_book)
+  : shards_(shard_cores.empty() ? 1 : shard_cores.size()),
+    max_orders_per_book_(max_orders_per_book) {
+  for (size_t i = 0; i < shard_cores.size(); ++i)
+    shards_[i].core = shard_cores[i];
+}
+
+BookManager::~BookManager() { stop(); }
+
+SymbolId BookManager::add_symbol(std::string_view symbol) {
+  return add_symbol(symbol, max_orders_per_book_);
+}
+
+SymbolId BookManager::add_symbol(std::string_view symbol, size_t max_orders) {
+  const SymbolId id = symbols_.intern(symbol);
+  if (id < books_.size()) return id;
+  books_.emplace_back();
+  max_orders_.push_back(max_orders);
+  const uint32_t shard = static_cast<uint32_t>(id % shards_.size());
+  shard_of_.push_back(shard);
+  shards_[shard].symbols.push_back(id);
+  return id;
+}
+
+void BookManager::build_shard(size_t shard) {
+  for (SymbolId id : shards_[shard].symbols)
+    if (!books_[id]) books_[id] = std::make_unique<OrderBook>(max_orders_[id]);
+}
+
+void BookManager::build() {
+  if (running()) return;
+  for (size_t s = 0; s < shards_.size(); ++s) {
+    shards_[s].thread = std::thread([this, s] {
+      pin_thread_to_core(shards_[s].core);
+      build_shard(s);
+    });
+  }
+  for (auto& shard : shards_) shard.thread.join();
+}
+
+void BookManager::start(ShardFn fn) {
+  if (running_.exchange(true)) return;
+  for (size_t s = 0; s < shards_.size(); ++s) {
+    shards_[s].thread = std::thread([this, s, fn] {
+      pin_thread_to_core(shards_[s].core);
+      build_shard(s);
+      fn(s);
+    });
+  }
+}
+
+void BookManager::stop() {
+  running_.store(false, std::memory_order_release);
+  for (auto& shard : shards_)
+    if (shard.thread.joinable()) shard.thread.join();
+}
+
+} // namespace lumina
@@ -0,0 +1,87 @@
+#include "lumina/book_side.hpp"
+
+namespace lumina {
+
+BookSide::BookSide(Side side, ChunkedPool<PriceLevel>& pool, size_t ladder_ticks,
+                   size_t depth_levels)
+  : side_(side), pool_(pool), ladder_(side, ladder_ticks), depth_levels_(depth_levels) {}
+
+PriceLevel* BookSide::get_or_create(Price price) {
+  if (PriceLevel* found = ladder_.find(price)) return found;
+  PriceLevel* level = pool_.allocate();
+  if (!level) return nullptr;
+  level->price = price;
+  // Splice into the best-to-worst level list: prev is better, next is worse.
+  level->prev = ladder_.next_better(price);
+  level->next = level->prev ? level->prev->next : best_;
+  if (level->prev) level->prev->next = level;
+  if (level->next) level->next->prev = level;
+  ladder_.insert(price, level);
+  if (!best_ || better_price(side_, price, best_->price)) best_ = level;
+  on_level_added(level);
+  return level;
+}
+
+PriceLevel* BookSide::append(Price price, PriceLevel* worst) {
+  PriceLevel* level = pool_.allocate();
+  if (!level) return nullptr;
+  level->price = price;
+  level->prev = worst;
+  if (worst) worst->next = level;
+  else best_ = level;
+  ladder_.insert(price, level);
+  on_level_added(level);
+  return level;
+}
+
+void BookSide::remove(PriceLevel* level) {
+  ladder_.erase(level->price);
+  if (level->prev) level->prev->next = level->next;
+  if (level->next) level->next->prev = level->prev;
+  on_level_removed(level);
+  volume_ -= level->total_qty;
+  if (best_ == level) best_ = level->next;
+  pool_.deallocate(level);
+}
+
+/// A new (empty) level joins the top N if there is room or if it beats the
+/// current edge, in which case the edge level drops out.
+void BookSide::on_level_added(PriceLevel* level) {
+  if (depth_levels_ == 0) return;
+  if (top_levels_ < depth_levels_) {
+    ++top_levels_;
+    if (!top_edge_ || better_price(side_, top_edge_->price, level->price))
+      top_edge_ = level;
+  } else if (better_price(side_, level->price, top_edge_->price)) {
+    top_qty_ -= top_edge_->total_qty;
+    top_edge_ = top_edge_->prev;
+  }
+}
+
+/// A removed level inside the top N is replaced by the next level beyond
+/// the edge. Called after the level has been unlinked; its own prev/next
+/// still point at its former neighbours.
+void BookSide::on_level_removed(PriceLevel* level) {
+  if (!top_edge_ || better_price(side_, top_edge_->price, level->price)) return;
+  --top_levels_;
+  top_qty_ -= level->total_qty;
+  if (top_edge_ == level) top_edge_ = level->prev;
+  PriceLevel* next = top_edge_ ? top_edge_->next : level->next;
+  if (next) {
+    ++top_levels_;
+    top_qty_ += next->total_qty;
+    top_edge_ = next;
+  }
+}
+
+size_t BookSide::copy(size_t n, Price* price, Qty* qty, int* count) const {
+  size_t i = 0;
+  for (const PriceLevel* l = best_; l && i < n; l = l->next, ++i) {
+    price[i] = l->price;
+    qty[i] = l->total_qty;
+    count[i] = l->count;
+  }
+  return i;
+}
+
+} // namespace lumina
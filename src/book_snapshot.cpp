@@ -0,0 +1,134 @@
+#include "lumina/order_book.hpp"
+#include "lumina/book_snapshot.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+namespace lumina {
+
+namespace {
+template <typename T>
+void write_pod(std::ostream& out, const T& v) {
+  out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+bool read_pod(std::istream& in, T* v, size_t n = 1) {
+  const auto bytes = static_cast<std::streamsize>(sizeof(T) * n);
+  return in.read(reinterpret_cast<char*>(v), bytes).gcount() == bytes;
+}
+
+constexpr size_t RESTORE_BATCH = 256;
+} // namespace
+
+void OrderBook::clear() {
+  for (BookSide* book_side : {&bids_, &asks_}) {
+    while (PriceLevel* level = book_side->best()) {
+      for (OrderNodePool::Node* node = level->head; node;) {
+        OrderNodePool::Node* next = node->next;
+        order_index_.erase(node->order.id);
+        pool_.deallocate(node);
+        node = next;
+      }
+      level->head = level->tail = nullptr;
+      book_side->remove(level);
+    }
+  }
+}
+
+bool OrderBook::save_snapshot(std::ostream& out, uint64_t seq) const {
+  SnapshotHeader h{};
+  std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+  h.version = SNAPSHOT_VERSION;
+  h.seq = seq;
+  h.order_count = order_index_.size();
+  h.bid_levels = bids_.level_count();
+  h.ask_levels = asks_.level_count();
+  write_pod(out, h);
+  for (const BookSide* book_side : {&bids_, &asks_}) {
+    for (const PriceLevel* l = book_side->best(); l; l = l->next) {
+      write_pod(out, SnapshotLevel{l->price, static_cast<uint32_t>(l->count), 0});
+      for (const OrderNodePool::Node* n = l->head; n; n = n->next)
+        write_pod(out, SnapshotOrder{n->order.id, n->order.qty, n->order.created_ns,
+                                     n->order.post_only ? SNAPSHOT_POST_ONLY : 0, 0});
+    }
+  }
+  return static_cast<bool>(out);
+}
+
+bool OrderBook::load_snapshot(std::istream& in, uint64_t& seq) {
+  clear();
+  SnapshotHeader h{};
+  if (!read_pod(in, &h) || std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 ||
+      h.version != SNAPSHOT_VERSION || h.order_count > pool_.capacity() ||
+      h.order_count > order_index_.max_entries())
+    return false;
+  std::array<SnapshotOrder, RESTORE_BATCH> batch;
+  uint64_t restored = 0;
+  for (BookSide* book_side : {&bids_, &asks_}) {
+    const Side side = book_side->side();
+    const uint64_t levels = side == Side::Buy ? h.bid_levels : h.ask_levels;
+    PriceLevel* worst = nullptr;
+    for (uint64_t i = 0; i < levels; ++i) {
+      SnapshotLevel rec{};
+      if (!read_pod(in, &rec) || rec.order_count == 0 ||
+          (worst && !better_price(side, worst->price, rec.price))) {
+        clear();
+        return false;
+      }
+      PriceLevel* level = book_side->append(rec.price, worst);
+      if (!level) {
+        clear();
+        return false;
+      }
+      worst = level;
+      Qty level_qty = 0;
+      for (uint32_t done = 0; done < rec.order_count;) {
+        const size_t n = std::min<size_t>(RESTORE_BATCH, rec.order_count - done);
+        if (!read_pod(in, batch.data(), n)) {
+          book_side->apply_qty(level, level_qty);
+          clear();
+          return false;
+        }
+        for (size_t k = 0; k < n; ++k) {
+          OrderNodePool::Node* node = pool_.allocate();
+          if (!node || batch[k].qty <= 0 || !order_index_.insert(batch[k].id, node)) {
+            if (node) pool_.deallocate(node);
+            book_side->apply_qty(level, level_qty);
+            clear();
+            return false;
+          }
+          node->order.id = batch[k].id;
+          node->order.price = rec.price;
+          node->order.qty = batch[k].qty;
+          node->order.side = side;
+          node->order.post_only = (batch[k].flags & SNAPSHOT_POST_ONLY) != 0;
+          node->order.created_ns = batch[k].created_ns;
+          node->prev = level->tail;
+          if (level->tail) level->tail->next = node;
+          else level->head = node;
+          level->tail = node;
+          ++level->count;
+          level_qty += batch[k].qty;
+          ++restored;
+        }
+        done += static_cast<uint32_t>(n);
+      }
+      book_side->apply_qty(level, level_qty);
+    }
+  }
+  // Level records can parse cleanly from a truncated or corrupted stream;
+  // the header's order count and an uncrossed book are the cross-checks.
+  const PriceLevel* bid = bids_.best();
+  const PriceLevel* ask = asks_.best();
+  if (restored != h.order_count || (bid && ask && bid->price >= ask->price)) {
+    clear();
+    return false;
+  }
+  seq = h.seq;
+  return true;
+}
+
+} // namespace lumina
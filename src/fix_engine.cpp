@@ -1,7 +1,7 @@
 #include "lumina/fix_engine.hpp"
 #include <cstdlib>
 #include <cstring>
-#include <sstream>
+#include <charconv>
 
 namespace lumina {
 
@@ -55,18 +55,76 @@ bool FixEngine::parse(const char* msg, size_t len) {
   return false;
 }
 
+namespace {
+// Worst-case text around the variable fields, and digits per integer field.
+constexpr size_t NOS_FIXED = 48;
+constexpr size_t CANCEL_FIXED = 24;
+constexpr size_t MAX_DIGITS = 21;
+
+struct FixWriter {
+  char* p;
+  void text(std::string_view s) {
+    std::memcpy(p, s.data(), s.size());
+    p += s.size();
+  }
+  template <typename I>
+  void num(I v) { p = std::to_chars(p, p + MAX_DIGITS, v).ptr; }
+};
+
+size_t new_order_single_cap(std::string_view symbol) {
+  return NOS_FIXED + symbol.size() + 3 * MAX_DIGITS;
+}
+
+size_t write_new_order_single(char* out, OrderId cl_ord_id, std::string_view symbol,
+                              Side side, Qty qty, Price price) {
+  FixWriter w{out};
+  w.text("35=D|11=");
+  w.num(cl_ord_id);
+  w.text("|55=");
+  w.text(symbol);
+  w.text(side == Side::Buy ? "|54=1" : "|54=2");
+  w.text("|40=2|44=");
+  w.num(price);
+  w.text("|38=");
+  w.num(qty);
+  w.text("|59=1|");
+  return static_cast<size_t>(w.p - out);
+}
+
+size_t write_cancel_request(char* out, OrderId cl_ord_id, OrderId orig_cl_ord_id) {
+  FixWriter w{out};
+  w.text("35=F|11=");
+  w.num(cl_ord_id);
+  w.text("|41=");
+  w.num(orig_cl_ord_id);
+  w.text("|");
+  return static_cast<size_t>(w.p - out);
+}
+} // namespace
+
 std::string FixEngine::build_new_order_single(OrderId cl_ord_id, const std::string& symbol,
                                               Side side, Qty qty, Price price) {
-  std::ostringstream os;
-  os << "35=D|11=" << cl_ord_id << "|55=" << symbol << "|54=" << (side == Side::Buy ? "1" : "2")
-     << "|40=2|44=" << price << "|38=" << qty << "|59=1|";
-  return os.str();
+  std::string msg(new_order_single_cap(symbol), '\0');
+  msg.resize(write_new_order_single(msg.data(), cl_ord_id, symbol, side, qty, price));
+  return msg;
 }
 
 std::string FixEngine::build_cancel_request(OrderId cl_ord_id, OrderId orig_cl_ord_id) {
-  std::ostringstream os;
-  os << "35=F|11=" << cl_ord_id << "|41=" << orig_cl_ord_id << "|";
-  return os.str();
+  char buf[CANCEL_FIXED + 2 * MAX_DIGITS];
+  return std::string(buf, write_cancel_request(buf, cl_ord_id, orig_cl_ord_id));
+}
+
+std::string_view FixEngine::build_new_order_single(ScratchArena& out, OrderId cl_ord_id,
+                                                   std::string_view symbol, Side side,
+                                                   Qty qty, Price price) {
+  char* buf = out.allocate_array<char>(new_order_single_cap(symbol));
+  return {buf, write_new_order_single(buf, cl_ord_id, symbol, side, qty, price)};
+}
+
+std::string_view FixEngine::build_cancel_request(ScratchArena& out, OrderId cl_ord_id,
+                                                 OrderId orig_cl_ord_id) {
+  char* buf = out.allocate_array<char>(CANCEL_FIXED + 2 * MAX_DIGITS);
+  return {buf, write_cancel_request(buf, cl_ord_id, orig_cl_ord_id)};
 }
 
 } // namespace lumina
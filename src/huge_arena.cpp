@@ -0,0 +1,82 @@
+#include "lumina/huge_arena.hpp"
+#include <cstring>
+#include <new>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lumina {
+
+namespace {
+constexpr size_t round_up(size_t n, size_t to) { return (n + to - 1) / to * to; }
+
+#ifdef __linux__
+constexpr int MPOL_PREFERRED_MODE = 1;  // <numaif.h> MPOL_PREFERRED; avoids a libnuma dependency
+
+/// Prefer node for [p, p + bytes). Preferred rather than strict binding, so
+/// an exhausted node falls back to another instead of failing the fault.
+bool bind_to_node(void* p, size_t bytes, int node) {
+  if (node < 0 || node >= 64) return false;
+  const unsigned long mask = 1UL << node;
+  return syscall(SYS_mbind, p, bytes, MPOL_PREFERRED_MODE, &mask, 64UL, 0U) == 0;
+}
+#endif
+} // namespace
+
+int current_numa_node() {
+#ifdef __linux__
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return static_cast<int>(node);
+#endif
+  return 0;
+}
+
+HugeArena::HugeArena(size_t bytes, ArenaOptions options) {
+  capacity_ = round_up(bytes ? bytes : 1, HUGE_PAGE_SIZE);
+#ifdef __linux__
+  void* p = MAP_FAILED;
+  if (options.huge_pages) {
+    p = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) backing_ = PageBacking::HugeTlb;
+  }
+  if (p == MAP_FAILED) {
+    p = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    if (options.huge_pages && ::madvise(p, capacity_, MADV_HUGEPAGE) == 0)
+      backing_ = PageBacking::TransparentHuge;
+  }
+  base_ = static_cast<char*>(p);
+  const int node = options.numa_node == NUMA_LOCAL ? current_numa_node() : options.numa_node;
+  if (node != NUMA_ANY && bind_to_node(base_, capacity_, node)) numa_node_ = node;
+  if (options.prefault) {
+    // Write one byte per 4K page (covers hugepages too) so every page is
+    // faulted in, on the bound node, before the session starts.
+    for (size_t off = 0; off < capacity_; off += 4096)
+      static_cast<volatile char*>(base_)[off] = 0;
+  }
+#else
+  base_ = static_cast<char*>(::operator new(capacity_, std::align_val_t{HUGE_PAGE_SIZE}));
+  if (options.prefault) std::memset(base_, 0, capacity_);
+#endif
+}
+
+HugeArena::~HugeArena() {
+#ifdef __linux__
+  if (base_) ::munmap(base_, capacity_);
+#else
+  ::operator delete(base_, std::align_val_t{HUGE_PAGE_SIZE});
+#endif
+}
+
+void* HugeArena::allocate(size_t bytes, size_t align) {
+  const size_t offset = round_up(used_, align);
+  if (offset > capacity_ || bytes > capacity_ - offset) return nullptr;
+  used_ = offset + bytes;
+  return base_ + offset;
+}
+
+} // namespace lumina
@@ -0,0 +1,278 @@
+#include "lumina/itch_feed.hpp"
+#include "lumina/thread_utils.hpp"
+#include <cstring>
+#include <ostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lumina {
+
+namespace {
+constexpr char side_code(Side side) { return side == Side::Buy ? 'B' : 'S'; }
+constexpr Side side_of(char code) { return code == 'S' ? Side::Sell : Side::Buy; }
+
+template <typename M>
+const M& record(const char* p) {
+  return *reinterpret_cast<const M*>(p);
+}
+} // namespace
+
+// ---- ItchWriter ----
+
+ItchWriter::ItchWriter(std::ostream& out) : out_(out) {
+  ItchFileHeader h{};
+  std::memcpy(h.magic, ITCH_MAGIC, sizeof(h.magic));
+  h.version = ITCH_VERSION;
+  out_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+}
+
+template <typename M>
+void ItchWriter::write(M& msg, ItchType type, TimestampNs ts_ns) {
+  msg.h.length = sizeof(M);
+  msg.h.type = type;
+  msg.h.seq = ++seq_;
+  msg.h.ts_ns = ts_ns;
+  out_.write(reinterpret_cast<const char*>(&msg), sizeof(M));
+}
+
+void ItchWriter::add_order(TimestampNs ts_ns, OrderId id, Side side, Price price,
+                           uint32_t qty) {
+  ItchAddOrder m{};
+  m.id = id;
+  m.price = price;
+  m.qty = qty;
+  m.side = side_code(side);
+  write(m, ItchType::AddOrder, ts_ns);
+}
+
+void ItchWriter::cancel_order(TimestampNs ts_ns, OrderId id, uint32_t qty) {
+  ItchCancelOrder m{};
+  m.id = id;
+  m.qty = qty;
+  write(m, ItchType::CancelOrder, ts_ns);
+}
+
+void ItchWriter::delete_order(TimestampNs ts_ns, OrderId id) {
+  ItchDeleteOrder m{};
+  m.id = id;
+  write(m, ItchType::DeleteOrder, ts_ns);
+}
+
+void ItchWriter::execute_order(TimestampNs ts_ns, OrderId id, uint32_t qty) {
+  ItchExecuteOrder m{};
+  m.id = id;
+  m.qty = qty;
+  write(m, ItchType::ExecuteOrder, ts_ns);
+}
+
+void ItchWriter::replace_order(TimestampNs ts_ns, OrderId id, OrderId new_id, Price price,
+                               uint32_t qty) {
+  ItchReplaceOrder m{};
+  m.id = id;
+  m.new_id = new_id;
+  m.price = price;
+  m.qty = qty;
+  write(m, ItchType::ReplaceOrder, ts_ns);
+}
+
+void ItchWriter::trade(TimestampNs ts_ns, Side side, Price price, uint32_t qty) {
+  ItchTrade m{};
+  m.price = price;
+  m.qty = qty;
+  m.side = side_code(side);
+  write(m, ItchType::Trade, ts_ns);
+}
+
+bool ItchWriter::ok() const { return static_cast<bool>(out_); }
+
+// ---- MappedFile ----
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+  if (this != &o) {
+    close();
+    data_ = o.data_;
+    size_ = o.size_;
+    o.data_ = nullptr;
+    o.size_ = 0;
+  }
+  return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+  close();
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st {};
+  bool ok = ::fstat(fd, &st) == 0 && st.st_size > 0;
+  if (ok) {
+    const auto bytes = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ok = p != MAP_FAILED;
+    if (ok) {
+      ::madvise(p, bytes, MADV_SEQUENTIAL);
+      ::madvise(p, bytes, MADV_WILLNEED);
+      data_ = static_cast<const char*>(p);
+      size_ = bytes;
+    }
+  }
+  ::close(fd);
+  return ok;
+}
+
+void MappedFile::close() {
+  if (data_) ::munmap(const_cast<char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+// ---- ItchDecoder ----
+
+ItchDecoder::ItchDecoder(const char* data, size_t size) {
+  if (!data || size < sizeof(ItchFileHeader) ||
+      reinterpret_cast<uintptr_t>(data) % alignof(ItchHeader) != 0)
+    return;
+  const auto& h = record<ItchFileHeader>(data);
+  if (std::memcmp(h.magic, ITCH_MAGIC, sizeof(h.magic)) != 0 || h.version != ITCH_VERSION)
+    return;
+  data_ = data;
+  size_ = size;
+  pos_ = sizeof(ItchFileHeader);
+}
+
+ItchDecoder ItchDecoder::records(const char* data, size_t size) {
+  ItchDecoder d;
+  if (data && reinterpret_cast<uintptr_t>(data) % alignof(ItchHeader) == 0) {
+    d.data_ = data;
+    d.size_ = size;
+  }
+  return d;
+}
+
+bool ItchDecoder::peek_ts(TimestampNs& ts) const {
+  if (done() || size_ - pos_ < sizeof(ItchHeader)) return false;
+  ts = record<ItchHeader>(data_ + pos_).ts_ns;
+  return true;
+}
+
+size_t ItchDecoder::decode(FeedMessage* out, size_t max) {
+  size_t n = 0;
+  while (n < max && !done()) {
+    const char* p = data_ + pos_;
+    const size_t left = size_ - pos_;
+    if (left < sizeof(ItchHeader)) {
+      error_ = true;
+      break;
+    }
+    const ItchHeader& h = record<ItchHeader>(p);
+    if (h.length < sizeof(ItchHeader) || h.length < min_len(h.type) || h.length > left ||
+        h.length % 8 != 0) {
+      error_ = true;
+      break;
+    }
+    FeedMessage& m = out[n];
+    m = FeedMessage{};
+    m.seq = h.seq;
+    m.ts_ns = h.ts_ns;
+    bool known = true;
+    switch (h.type) {
+    case ItchType::AddOrder: {
+      const auto& r = record<ItchAddOrder>(p);
+      m.type = FeedMsgType::AddOrder;
+      m.id = r.id;
+      m.side = side_of(r.side);
+      m.price = r.price;
+      m.qty = r.qty;
+      break;
+    }
+    case ItchType::CancelOrder: {
+      const auto& r = record<ItchCancelOrder>(p);
+      m.type = FeedMsgType::CancelOrder;
+      m.id = r.id;
+      m.qty = r.qty;
+      break;
+    }
+    case ItchType::DeleteOrder:
+      m.type = FeedMsgType::DeleteOrder;
+      m.id = record<ItchDeleteOrder>(p).id;
+      break;
+    case ItchType::ExecuteOrder: {
+      const auto& r = record<ItchExecuteOrder>(p);
+      m.type = FeedMsgType::ExecuteOrder;
+      m.id = r.id;
+      m.qty = r.qty;
+      break;
+    }
+    case ItchType::ReplaceOrder: {
+      const auto& r = record<ItchReplaceOrder>(p);
+      m.type = FeedMsgType::ReplaceOrder;
+      m.id = r.id;
+      m.new_id = r.new_id;
+      m.price = r.price;
+      m.qty = r.qty;
+      break;
+    }
+    case ItchType::Trade: {
+      const auto& r = record<ItchTrade>(p);
+      m.type = FeedMsgType::Trade;
+      m.side = side_of(r.side);
+      m.price = r.price;
+      m.qty = r.qty;
+      break;
+    }
+    default:
+      known = false;
+      break;
+    }
+    pos_ += h.length;
+    if (known) {
+      ++n;
+      ++decoded_;
+    } else {
+      ++skipped_;
+    }
+  }
+  return n;
+}
+
+// ---- ReplayFeedSource ----
+
+bool ReplayFeedSource::open(const std::string& path) {
+  if (!file_.open(path)) return false;
+  decoder_ = ItchDecoder(file_.data(), file_.size());
+  started_ = false;
+  return decoder_.valid();
+}
+
+bool ReplayFeedSource::open_buffer(const char* data, size_t size) {
+  file_.close();
+  decoder_ = ItchDecoder(data, size);
+  started_ = false;
+  return decoder_.valid();
+}
+
+size_t ReplayFeedSource::poll(FeedMessage* out, size_t max) {
+  if (options_.pace == ReplayPace::MaxSpeed) return decoder_.decode(out, max);
+  const TimestampNs now = monotonic_ns();
+  TimestampNs ts = 0;
+  if (!started_) {
+    if (!decoder_.peek_ts(ts)) return decoder_.decode(out, max);
+    wall_start_ = now;
+    feed_start_ = ts;
+    started_ = true;
+  }
+  const auto due = feed_start_ +
+                   static_cast<TimestampNs>(static_cast<double>(now - wall_start_) * options_.speed);
+  size_t n = 0;
+  while (n < max && !decoder_.done()) {
+    // A record too short to peek is left to decode(), which flags it.
+    if (decoder_.peek_ts(ts) && ts > due) break;
+    const size_t got = decoder_.decode(out + n, 1);
+    if (got == 0 && decoder_.done()) break;
+    n += got;
+  }
+  return n;
+}
+
+} // namespace lumina
@@ -3,6 +3,11 @@
 
 namespace lumina {
 
+KDBMock::KDBMock(HugeArena* arena, size_t reserve_ticks)
+  : ticks_(ArenaAllocator<TickRecord>(arena)) {
+  ticks_.reserve(reserve_ticks);
+}
+
 void KDBMock::insert(const TickRecord& rec) {
   std::lock_guard<std::mutex> lock(mtx_);
   ticks_.push_back(rec);
@@ -1,16 +1,66 @@
 #include "lumina/market_data_handler.hpp"
 #include "lumina/thread_utils.hpp"
-#include <chrono>
+#include <algorithm>
 
 namespace lumina {
 
-MarketDataHandler::MarketDataHandler(std::shared_ptr<MDRing> to_strategy)
-  : to_strategy_(std::move(to_strategy)) {}
+namespace {
+/// Apply an order-level message to an order-by-order book. Writes the level
+/// changes it caused (two for a replace) and returns how many; 0 for an
+/// unknown order or a rejected add.
+[[maybe_unused]] size_t apply_order_msg(OrderBook& book, const FeedMessage& m,
+                                        LevelChange* out) {
+  if (m.type == FeedMsgType::AddOrder) {
+    if (!book.add_order(m.id, m.price, m.qty, m.side, m.ts_ns)) return 0;
+    out[0] = {m.side, m.price, m.qty};
+    return 1;
+  }
+  const Order* order = book.find_order(m.id);
+  if (!order) return 0;
+  const Side side = order->side;
+  const Price price = order->price;
+  const Qty resting = order->qty;
+  switch (m.type) {
+  case FeedMsgType::CancelOrder:
+  case FeedMsgType::ExecuteOrder:
+    out[0] = {side, price, -book.reduce_order(m.id, m.qty)};
+    return out[0].delta ? 1 : 0;
+  case FeedMsgType::DeleteOrder:
+    book.cancel_order(m.id);
+    out[0] = {side, price, -resting};
+    return 1;
+  case FeedMsgType::ReplaceOrder:
+    book.cancel_order(m.id);
+    out[0] = {side, price, -resting};
+    if (!book.add_order(m.new_id, m.price, m.qty, side, m.ts_ns)) return 1;
+    out[1] = {side, m.price, m.qty};
+    return 2;
+  default:
+    return 0;
+  }
+}
+
+/// A price-level book keeps no order ids; it is fed LevelDelta and Trade.
+[[maybe_unused]] size_t apply_order_msg(MbpBook&, const FeedMessage&, LevelChange*) {
+  return 0;
+}
+
+void add_relaxed(std::atomic<uint64_t>& counter, uint64_t v) {
+  counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+} // namespace
+
+MarketDataHandler::MarketDataHandler(std::shared_ptr<MDRing> to_strategy,
+                                     MDHandlerOptions options)
+  : to_strategy_(std::move(to_strategy)), options_(options) {
+  options_.batch = std::clamp<size_t>(options_.batch, 1, MAX_FEED_BATCH);
+}
 
 MarketDataHandler::~MarketDataHandler() { stop(); }
 
 void MarketDataHandler::start() {
   if (running_.exchange(true)) return;
+  feed_finished_.store(false, std::memory_order_relaxed);
   thread_ = std::thread(&MarketDataHandler::run, this);
 }
 
@@ -20,39 +70,139 @@ void MarketDataHandler::stop() {
 }
 
 void MarketDataHandler::on_trade(Price price, Qty qty, TimestampNs ts_ns) {
+  publish_trade(price, qty, ts_ns, nullptr);
+}
+
+void MarketDataHandler::on_book_update(Side side, Price price, Qty delta_qty, bool is_add,
+                                       TimestampNs ts_ns) {
+  const Qty applied = book_.apply_delta(side, price, is_add ? delta_qty : -delta_qty);
+  if (applied == 0) return;
+  publish_delta({side, price, applied}, ts_ns);
+}
+
+void MarketDataHandler::publish_trade(Price price, Qty qty, TimestampNs ts_ns,
+                                      const LevelChange* executed) {
   MarketDataEvent ev{};
   ev.flag = MDFlag::Trade;
-  ev.ts_ns = ts_ns;
-  ev.last_trade.price = price;
-  ev.last_trade.qty = qty;
-  ev.last_trade.time_ns = ts_ns;
-  ev.mid = book_.mid_price();
-  ev.bid = book_.best_bid();
-  ev.ask = book_.best_ask();
-  ev.bid_qty = book_.best_bid_level().total_qty;
-  ev.ask_qty = book_.best_ask_level().total_qty;
-  book_.get_bid_ask_volumes(ev.bid_volume, ev.ask_volume);
-  to_strategy_->try_push(ev);
-}
-
-void MarketDataHandler::on_book_update(Side side, Price price, Qty delta_qty, bool is_add) {
-  (void)side;
-  (void)price;
-  (void)delta_qty;
-  (void)is_add;
+  ev.trade.price = price;
+  ev.trade.qty = to_event_qty(qty);
+  ev.trade.level_qty = NO_LEVEL;
+  if (executed) {
+    ev.side = executed->side;
+    ev.trade.level_qty = to_event_qty(book_.level_qty(executed->side, executed->price));
+  }
+  publish(ev, ts_ns);
+}
+
+void MarketDataHandler::publish_delta(const LevelChange& change, TimestampNs ts_ns) {
   MarketDataEvent ev{};
   ev.flag = MDFlag::BookUpdate;
-  ev.mid = book_.mid_price();
-  ev.bid = book_.best_bid();
-  ev.ask = book_.best_ask();
-  book_.get_bid_ask_volumes(ev.bid_volume, ev.ask_volume);
-  to_strategy_->try_push(ev);
+  ev.side = change.side;
+  ev.level.price = change.price;
+  ev.level.delta = to_event_qty(change.delta);
+  ev.level.level_qty = to_event_qty(book_.level_qty(change.side, change.price));
+  publish(ev, ts_ns);
+}
+
+/// Republish the top of book, stamp it (with its sequence number) on ev
+/// and hand ev to the strategy: through the ring, or, for a book update
+/// while the strategy is behind, as a top-of-book state in the conflation
+/// slot.
+void MarketDataHandler::publish(MarketDataEvent& ev, TimestampNs ts_ns) {
+  const BookLevel bid = book_.best_bid_level();
+  const BookLevel ask = book_.best_ask_level();
+  TopOfBook top;
+  top.bid = bid.price;
+  top.ask = ask.price;
+  top.bid_qty = bid.total_qty;
+  top.ask_qty = ask.total_qty;
+  book_.get_bid_ask_volumes(top.bid_volume, top.ask_volume);
+  top.ts_ns = ts_ns;
+  top_.publish(top);
+
+  ev.seq = ++seq_;
+  ev.ts_ns = ts_ns;
+  ev.bid = top.bid;
+  ev.ask = top.ask;
+  ev.bid_volume = to_event_qty(top.bid_volume);
+  ev.ask_volume = to_event_qty(top.ask_volume);
+  // Free space from the producer's cached read index: the consumer's
+  // cursor line is only pulled over when the queue looks deep.
+  if (conflation_ && ev.flag == MDFlag::BookUpdate && !to_strategy_->has_room(conflate_room_)) {
+    ev.flag = MDFlag::BestBidAsk;
+    ev.top = {to_event_qty(top.bid_qty), to_event_qty(top.ask_qty), 0};
+    conflation_->park(ev);
+    add_relaxed(conflated_, 1);
+    return;
+  }
+  if (!to_strategy_->try_push(ev)) add_relaxed(dropped_, 1);
+}
+
+void MarketDataHandler::apply(const FeedMessage& msg) {
+  last_seq_ = msg.seq;
+  switch (msg.type) {
+  case FeedMsgType::Trade:
+    on_trade(msg.price, msg.qty, msg.ts_ns);
+    return;
+  case FeedMsgType::LevelDelta:
+    on_book_update(msg.side, msg.price, msg.qty < 0 ? -msg.qty : msg.qty, msg.qty > 0,
+                   msg.ts_ns);
+    return;
+  default: {
+    LevelChange changes[2];
+    const size_t n = apply_order_msg(book_, msg, changes);
+    for (size_t i = 0; i < n; ++i) {
+      if (msg.type == FeedMsgType::ExecuteOrder)
+        publish_trade(changes[i].price, -changes[i].delta, msg.ts_ns, &changes[i]);
+      else
+        publish_delta(changes[i], msg.ts_ns);
+    }
+    return;
+  }
+  }
+}
+
+size_t MarketDataHandler::poll_feed() {
+  if (!feed_) return 0;
+  const TimestampNs start = monotonic_ns();
+  const size_t n = feed_->poll(batch_.data(), options_.batch);
+  if (n == 0) return 0;
+  for (size_t i = 0; i < n; ++i) apply(batch_[i]);
+  const uint64_t ns = static_cast<uint64_t>(monotonic_ns() - start);
+  add_relaxed(messages_, n);
+  add_relaxed(batches_, 1);
+  add_relaxed(busy_ns_, ns);
+  if (ns > max_batch_ns_.load(std::memory_order_relaxed))
+    max_batch_ns_.store(ns, std::memory_order_relaxed);
+  return n;
+}
+
+MDLoopStats MarketDataHandler::loop_stats() const {
+  MDLoopStats s;
+  s.messages = messages_.load(std::memory_order_relaxed);
+  s.batches = batches_.load(std::memory_order_relaxed);
+  s.busy_ns = busy_ns_.load(std::memory_order_relaxed);
+  s.max_batch_ns = max_batch_ns_.load(std::memory_order_relaxed);
+  s.idle_passes = idle_passes_.load(std::memory_order_relaxed);
+  s.conflated = conflated_.load(std::memory_order_relaxed);
+  s.dropped = dropped_.load(std::memory_order_relaxed);
+  return s;
 }
 
 void MarketDataHandler::run() {
-  pin_thread_to_core(1);
+  if (options_.core != NO_CORE_PIN) pin_thread_to_core(static_cast<uint32_t>(options_.core));
+  uint64_t empty_passes = 0;
   while (running_.load(std::memory_order_acquire)) {
-    std::this_thread::sleep_for(std::chrono::microseconds(10));
+    if (poll_feed()) {
+      empty_passes = 0;
+      continue;
+    }
+    if (feed_ && feed_->finished()) {
+      feed_finished_.store(true, std::memory_order_release);
+      break;
+    }
+    add_relaxed(idle_passes_, 1);
+    options_.idle.idle(empty_passes++);
   }
 }
 
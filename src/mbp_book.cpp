@@ -0,0 +1,79 @@
+#include "lumina/mbp_book.hpp"
+
+namespace lumina {
+
+static_assert(DepthBook<MbpBook>);
+
+MbpBook::MbpBook(size_t ladder_ticks, size_t depth_levels, size_t max_levels,
+                 HugeArena* arena)
+  : level_pool_(max_levels, 64, arena),
+    bids_(Side::Buy, level_pool_, ladder_ticks, depth_levels),
+    asks_(Side::Sell, level_pool_, ladder_ticks, depth_levels) {}
+
+bool MbpBook::set_level(Side side, Price price, Qty qty, int count) {
+  BookSide& book_side = side_of(side);
+  if (qty <= 0) {
+    delete_level(side, price);
+    return true;
+  }
+  PriceLevel* level = book_side.get_or_create(price);
+  if (!level) return false;
+  book_side.apply_qty(level, qty - level->total_qty);
+  level->count = count;
+  return true;
+}
+
+void MbpBook::delete_level(Side side, Price price) {
+  BookSide& book_side = side_of(side);
+  if (PriceLevel* level = book_side.find(price)) book_side.remove(level);
+}
+
+Qty MbpBook::apply_delta(Side side, Price price, Qty delta, int count_delta) {
+  BookSide& book_side = side_of(side);
+  PriceLevel* level = book_side.find(price);
+  if (!level) {
+    if (delta <= 0) return 0;
+    level = book_side.get_or_create(price);
+    if (!level) return 0;
+  }
+  const Qty applied = delta < -level->total_qty ? -level->total_qty : delta;
+  book_side.apply_qty(level, applied);
+  level->count += count_delta;
+  if (level->total_qty <= 0) book_side.remove(level);
+  return applied;
+}
+
+void MbpBook::clear() {
+  while (PriceLevel* l = bids_.best()) bids_.remove(l);
+  while (PriceLevel* l = asks_.best()) asks_.remove(l);
+}
+
+Price MbpBook::best_bid() const {
+  return bids_.best() ? bids_.best()->price : 0;
+}
+
+Price MbpBook::best_ask() const {
+  return asks_.best() ? asks_.best()->price : 0;
+}
+
+Price MbpBook::mid_price() const {
+  Price b = best_bid(), a = best_ask();
+  if (b == 0 && a == 0) return 0;
+  if (b == 0) return a;
+  if (a == 0) return b;
+  return (b + a) / 2;
+}
+
+BookLevel MbpBook::best_bid_level() const {
+  const PriceLevel* l = bids_.best();
+  if (!l) return {};
+  return {l->price, l->total_qty, l->count};
+}
+
+BookLevel MbpBook::best_ask_level() const {
+  const PriceLevel* l = asks_.best();
+  if (!l) return {};
+  return {l->price, l->total_qty, l->count};
+}
+
+} // namespace lumina
@@ -1,9 +1,44 @@
 #include "lumina/memory_pool.hpp"
+#include <mutex>
 #include <stdexcept>
 
 namespace lumina {
 
-OrderNodePool::OrderNodePool(size_t max_orders) : capacity_(max_orders) {
+namespace {
+// Thread ids for pool magazines, recycled on thread exit. Only touched on
+// a thread's first pool use and at its exit.
+std::mutex slot_mutex;
+std::vector<uint32_t> free_slots;
+uint32_t next_slot = 0;
+
+struct ThreadSlot {
+  uint32_t id;
+  ThreadSlot() {
+    std::lock_guard<std::mutex> lock(slot_mutex);
+    if (!free_slots.empty()) {
+      id = free_slots.back();
+      free_slots.pop_back();
+    } else {
+      id = next_slot < MAX_POOL_THREADS ? next_slot++ : static_cast<uint32_t>(MAX_POOL_THREADS);
+    }
+  }
+  ~ThreadSlot() {
+    if (id >= MAX_POOL_THREADS) return;
+    std::lock_guard<std::mutex> lock(slot_mutex);
+    free_slots.push_back(id);
+  }
+};
+} // namespace
+
+uint32_t acquire_pool_thread_slot() {
+  thread_local ThreadSlot slot;  // returns the id when the thread exits
+  return slot.id;
+}
+
+OrderNodePool::OrderNodePool(size_t max_orders, HugeArena* arena)
+  : block_(ArenaAllocator<Node>(arena)),
+    free_list_(ArenaAllocator<Node*>(arena)),
+    capacity_(max_orders) {
   block_.resize(max_orders);
   free_list_.resize(max_orders);
   for (size_t i = 0; i < max_orders; ++i)
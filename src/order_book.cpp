@@ -1,93 +1,83 @@
 #include "lumina/order_book.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace lumina {
 
-OrderBook::OrderBook(size_t max_orders)
-  : pool_(max_orders),
-    level_storage_(),
-    best_bid_(nullptr),
-    best_ask_(nullptr) {
-  level_storage_.reserve(4096);
+namespace {
+/// True if a taker on the given side with this limit trades at price.
+inline bool crosses(Side taker, Price limit, Price price) {
+  return taker == Side::Buy ? price <= limit : price >= limit;
 }
+} // namespace
 
-PriceLevel* OrderBook::get_or_create_level(Price price, Side side) {
-  PriceToLevel& levels = side == Side::Buy ? bid_levels_ : ask_levels_;
-  auto it = levels.find(price);
-  if (it != levels.end()) return it->second;
-  level_storage_.emplace_back();
-  PriceLevel* level = &level_storage_.back();
-  level->price = price;
-  level->total_qty = 0;
-  level->head = level->tail = nullptr;
-  level->prev = level->next = nullptr;
-  levels[price] = level;
-  return level;
-}
+static_assert(DepthBook<OrderBook>);
+
+OrderBook::OrderBook(size_t max_orders, size_t ladder_ticks, size_t depth_levels,
+                     size_t max_levels, HugeArena* arena)
+  : pool_(max_orders, arena),
+    level_pool_(max_levels, 64, arena),
+    bids_(Side::Buy, level_pool_, ladder_ticks, depth_levels),
+    asks_(Side::Sell, level_pool_, ladder_ticks, depth_levels),
+    order_index_(max_orders, arena) {}
 
 void OrderBook::remove_level_if_empty(PriceLevel* level, Side side) {
-  if (!level || level->total_qty > 0) return;
-  PriceToLevel& levels = side == Side::Buy ? bid_levels_ : ask_levels_;
-  levels.erase(level->price);
-  if (level->prev) level->prev->next = level->next;
-  if (level->next) level->next->prev = level->prev;
-  if (best_bid_ == level) update_best(Side::Buy);
-  if (best_ask_ == level) update_best(Side::Sell);
-}
-
-void OrderBook::update_best(Side side) {
-  PriceToLevel& levels = side == Side::Buy ? bid_levels_ : ask_levels_;
-  if (levels.empty()) {
-    if (side == Side::Buy) best_bid_ = nullptr;
-    else best_ask_ = nullptr;
-    return;
-  }
-  if (side == Side::Buy) {
-    best_bid_ = std::max_element(levels.begin(), levels.end(),
-      [](const auto& a, const auto& b) { return a.first < b.first; })->second;
-  } else {
-    best_ask_ = std::min_element(levels.begin(), levels.end(),
-      [](const auto& a, const auto& b) { return a.first < b.first; })->second;
-  }
+  if (!level || level->head) return;
+  side_of(side).remove(level);
 }
 
-bool OrderBook::add_order(OrderId id, Price price, Qty qty, Side side) {
-  if (order_index_.count(id)) return false;
+bool OrderBook::add_order(OrderId id, Price price, Qty qty, Side side, TimestampNs ts_ns) {
+  return rest_order(id, price, qty, side, false, ts_ns) != nullptr;
+}
+
+OrderNodePool::Node* OrderBook::rest_order(OrderId id, Price price, Qty qty, Side side,
+                                           bool post_only, TimestampNs ts_ns) {
+  if (qty <= 0) return nullptr;
   OrderNodePool::Node* node = pool_.allocate();
-  if (!node) return false;
+  if (!node) return nullptr;
+  if (!order_index_.insert(id, node)) {
+    pool_.deallocate(node);
+    return nullptr;
+  }
   node->order.id = id;
   node->order.price = price;
   node->order.qty = qty;
   node->order.side = side;
-  PriceLevel* level = get_or_create_level(price, side);
+  node->order.post_only = post_only;
+  node->order.created_ns = ts_ns;
+  BookSide& book_side = side_of(side);
+  PriceLevel* level = book_side.get_or_create(price);
+  if (!level) {
+    order_index_.erase(id);
+    pool_.deallocate(node);
+    return nullptr;
+  }
   node->prev = level->tail;
   node->next = nullptr;
   if (level->tail) level->tail->next = node;
   else level->head = node;
   level->tail = node;
-  level->total_qty += qty;
-  order_index_[id] = node;
-  if (!best_bid_ || (side == Side::Buy && price > best_bid_->price))
-    update_best(Side::Buy);
-  if (!best_ask_ || (side == Side::Sell && price < best_ask_->price))
-    update_best(Side::Sell);
-  return true;
+  ++level->count;
+  book_side.apply_qty(level, qty);
+  return node;
 }
 
-void OrderBook::cancel_order(OrderId id) {
-  auto it = order_index_.find(id);
-  if (it == order_index_.end()) return;
-  OrderNodePool::Node* node = it->second;
-  Side side = node->order.side;
-  Price price = node->order.price;
-  PriceLevel* level = get_or_create_level(price, side);
+void OrderBook::unlink_order(PriceLevel* level, OrderNodePool::Node* node) {
   if (node->prev) node->prev->next = node->next;
   else level->head = node->next;
   if (node->next) node->next->prev = node->prev;
   else level->tail = node->prev;
-  level->total_qty -= node->order.qty;
-  order_index_.erase(it);
+  --level->count;
+}
+
+void OrderBook::cancel_order(OrderId id) {
+  OrderNodePool::Node* node = order_index_.erase(id);
+  if (!node) return;
+  Side side = node->order.side;
+  PriceLevel* level = side_of(side).find(node->order.price);
+  unlink_order(level, node);
+  side_of(side).apply_qty(level, -node->order.qty);
   pool_.deallocate(node);
   remove_level_if_empty(level, side);
 }
@@ -98,51 +88,161 @@ void OrderBook::cancel_order(OrderId id, Price price, Side side) {
   cancel_order(id);
 }
 
-void OrderBook::match(Side side, Qty qty, std::vector<Trade>& fills) {
-  PriceLevel* level = side == Side::Buy ? best_ask_ : best_bid_;
-  while (level && qty > 0) {
-    OrderNodePool::Node* node = side == Side::Buy ? level->head : level->head;
+Qty OrderBook::reduce_order(OrderId id, Qty qty) {
+  OrderNodePool::Node* node = order_index_.find(id);
+  if (!node || qty <= 0) return 0;
+  if (qty >= node->order.qty) {
+    const Qty removed = node->order.qty;
+    cancel_order(id);
+    return removed;
+  }
+  BookSide& book_side = side_of(node->order.side);
+  book_side.apply_qty(book_side.find(node->order.price), -qty);
+  node->order.qty -= qty;
+  return qty;
+}
+
+const Order* OrderBook::find_order(OrderId id) const {
+  const OrderNodePool::Node* node = order_index_.find(id);
+  return node ? &node->order : nullptr;
+}
+
+Qty OrderBook::apply_delta(Side side, Price price, Qty delta, int count_delta) {
+  (void)count_delta;
+  const OrderId id = level_order_id(side, price);
+  if (delta < 0) return -reduce_order(id, -delta);
+  if (delta == 0) return 0;
+  if (OrderNodePool::Node* node = order_index_.find(id)) {
+    BookSide& book_side = side_of(side);
+    book_side.apply_qty(book_side.find(price), delta);
+    node->order.qty += delta;
+    return delta;
+  }
+  return add_order(id, price, delta, side) ? delta : 0;
+}
+
+Qty OrderBook::level_qty(Side side, Price price) const {
+  const PriceLevel* level = side_of(side).find(price);
+  return level ? level->total_qty : 0;
+}
+
+/// Opposite-side qty a taker could trade up to limit, stopping once needed
+/// is reached (FOK pre-check). Walks only the levels that would be hit.
+Qty OrderBook::fillable_qty(Side side, Price limit, Qty needed) const {
+  Qty avail = 0;
+  for (const PriceLevel* l = contra_of(side).best();
+       l && avail < needed && crosses(side, limit, l->price); l = l->next)
+    avail += l->total_qty;
+  return avail;
+}
+
+/// Fill a taker against the opposite side, best price first and FIFO within
+/// a level, until qty is done or the next level is beyond limit.
+Qty OrderBook::sweep(Side side, Price limit, Qty qty, OrderId taker_id,
+                     TimestampNs ts_ns, FillSink& fills) {
+  BookSide& book_side = contra_of(side);
+  Qty filled = 0;
+  PriceLevel* level = book_side.best();
+  while (level && qty > 0 && crosses(side, limit, level->price)) {
+    OrderNodePool::Node* node = level->head;
     while (node && qty > 0) {
-      Qty fill_qty = std::min(node->order.qty, qty);
-      fills.push_back({node->order.id, 0, level->price, fill_qty, 0});
+      OrderNodePool::Node* next = node->next;
+      const Qty fill_qty = std::min(node->order.qty, qty);
+      const OrderId maker_id = node->order.id;
+      fills.push_back({side == Side::Buy ? taker_id : maker_id,
+                       side == Side::Buy ? maker_id : taker_id,
+                       level->price, fill_qty, ts_ns});
       node->order.qty -= fill_qty;
-      level->total_qty -= fill_qty;
+      book_side.apply_qty(level, -fill_qty);
       qty -= fill_qty;
+      filled += fill_qty;
       if (node->order.qty == 0) {
-        OrderNodePool::Node* to_remove = node;
-        node = node->next;
-        if (to_remove->prev) to_remove->prev->next = to_remove->next;
-        else level->head = to_remove->next;
-        if (to_remove->next) to_remove->next->prev = to_remove->prev;
-        else level->tail = to_remove->prev;
-        order_index_.erase(to_remove->order.id);
-        pool_.deallocate(to_remove);
-      } else
-        node = node->next;
+        unlink_order(level, node);
+        order_index_.erase(maker_id);
+        pool_.deallocate(node);
+      }
+      node = next;
     }
-    remove_level_if_empty(level, side == Side::Buy ? Side::Sell : Side::Buy);
-    level = side == Side::Buy ? best_ask_ : best_bid_;
+    if (!level->head) book_side.remove(level);
+    level = book_side.best();
+  }
+  return filled;
+}
+
+Qty OrderBook::match(Side side, Qty qty, FillSink& fills,
+                     OrderId taker_id, TimestampNs ts_ns) {
+  const Price limit = side == Side::Buy ? std::numeric_limits<Price>::max()
+                                        : std::numeric_limits<Price>::min();
+  return sweep(side, limit, qty, taker_id, ts_ns, fills);
+}
+
+ExecReport OrderBook::submit_order(OrderId id, Price price, Qty qty, Side side,
+                                   TimeInForce tif, bool post_only, TimestampNs ts_ns,
+                                   FillSink& fills) {
+  ExecReport r{};
+  r.leaves_qty = qty;
+  if (qty <= 0 || order_index_.contains(id)) return r;
+  const PriceLevel* contra = contra_of(side).best();
+  const bool marketable = contra && crosses(side, price, contra->price);
+  if (marketable && post_only) return r;
+  if (tif == TimeInForce::FOK && fillable_qty(side, price, qty) < qty) return r;
+  if (marketable) r.filled_qty = sweep(side, price, qty, id, ts_ns, fills);
+  r.leaves_qty = qty - r.filled_qty;
+  if (r.leaves_qty == 0) {
+    r.status = ExecStatus::Filled;
+  } else if (tif != TimeInForce::GTC ||
+             !rest_order(id, price, r.leaves_qty, side, post_only, ts_ns)) {
+    r.status = ExecStatus::Cancelled;
+    r.leaves_qty = 0;
+  } else {
+    r.status = r.filled_qty > 0 ? ExecStatus::PartiallyFilled : ExecStatus::Rested;
+  }
+  return r;
+}
+
+ExecReport OrderBook::modify_order(OrderId id, Price price, Qty qty, TimestampNs ts_ns,
+                                   FillSink& fills) {
+  OrderNodePool::Node* node = order_index_.find(id);
+  if (!node) return {};
+  if (qty <= 0) {
+    cancel_order(id);
+    return {ExecStatus::Cancelled, 0, 0};
   }
+  const Side side = node->order.side;
+  if (price == node->order.price && qty <= node->order.qty) {
+    BookSide& book_side = side_of(side);
+    book_side.apply_qty(book_side.find(price), qty - node->order.qty);
+    node->order.qty = qty;
+    return {ExecStatus::Rested, 0, qty};
+  }
+  const bool post_only = node->order.post_only;
+  if (post_only) {
+    const PriceLevel* contra = contra_of(side).best();
+    if (contra && crosses(side, price, contra->price))
+      return {ExecStatus::Rejected, 0, node->order.qty};
+  }
+  cancel_order(id);
+  return submit_order(id, price, qty, side, TimeInForce::GTC, post_only, ts_ns, fills);
 }
 
 Price OrderBook::best_bid() const {
-  return best_bid_ ? best_bid_->price : 0;
+  return bids_.best() ? bids_.best()->price : 0;
 }
 
 Price OrderBook::best_ask() const {
-  return best_ask_ ? best_ask_->price : 0;
+  return asks_.best() ? asks_.best()->price : 0;
 }
 
 Qty OrderBook::bid_volume() const {
-  Qty v = 0;
-  for (const auto& p : bid_levels_) v += p.second->total_qty;
-  return v;
+  return bids_.volume();
 }
 
 Qty OrderBook::ask_volume() const {
-  Qty v = 0;
-  for (const auto& p : ask_levels_) v += p.second->total_qty;
-  return v;
+  return asks_.volume();
+}
+
+Qty OrderBook::depth_qty(Side side) const {
+  return side_of(side).top_qty();
 }
 
 Price OrderBook::mid_price() const {
@@ -154,13 +254,15 @@ Price OrderBook::mid_price() const {
 }
 
 BookLevel OrderBook::best_bid_level() const {
-  if (!best_bid_) return {};
-  return {best_bid_->price, best_bid_->total_qty, 0};
+  const PriceLevel* l = bids_.best();
+  if (!l) return {};
+  return {l->price, l->total_qty, l->count};
 }
 
 BookLevel OrderBook::best_ask_level() const {
-  if (!best_ask_) return {};
-  return {best_ask_->price, best_ask_->total_qty, 0};
+  const PriceLevel* l = asks_.best();
+  if (!l) return {};
+  return {l->price, l->total_qty, l->count};
 }
 
 void OrderBook::get_bid_ask_volumes(Qty& bid_vol, Qty& ask_vol) const {
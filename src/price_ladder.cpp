@@ -0,0 +1,169 @@
+#include "lumina/price_ladder.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace lumina {
+
+PriceLadder::PriceLadder(Side side, size_t window_ticks) : side_(side) {
+  size_t words = (std::max<size_t>(window_ticks, 64) + 63) / 64;
+  slots_.assign(words * 64, nullptr);
+  bits_.assign(words, 0);
+  summary_.assign((words + 63) / 64, 0);
+  overflow_.reserve(words * 64);
+}
+
+void PriceLadder::set_slot(size_t idx, PriceLevel* level) {
+  slots_[idx] = level;
+  bits_[idx / 64] |= uint64_t{1} << (idx % 64);
+  summary_[idx / 4096] |= uint64_t{1} << ((idx / 64) % 64);
+  ++window_count_;
+}
+
+void PriceLadder::clear_slot(size_t idx) {
+  slots_[idx] = nullptr;
+  uint64_t& word = bits_[idx / 64];
+  word &= ~(uint64_t{1} << (idx % 64));
+  if (!word)
+    summary_[idx / 4096] &= ~(uint64_t{1} << ((idx / 64) % 64));
+  --window_count_;
+}
+
+PriceLevel* PriceLadder::find(Price price) const {
+  const int64_t k = key(price);
+  if (in_window(k)) return slots_[k - base_];
+  auto it = std::lower_bound(overflow_.begin(), overflow_.end(), k,
+    [](const auto& e, int64_t v) { return e.first < v; });
+  if (it != overflow_.end() && it->first == k) return it->second;
+  return nullptr;
+}
+
+void PriceLadder::insert(Price price, PriceLevel* level) {
+  const int64_t k = key(price);
+  const int64_t headroom = static_cast<int64_t>(slots_.size() / 4);
+  if (size_ == 0) base_ = k - headroom;
+  else if (k < base_) reanchor(k - headroom);
+  ++size_;
+  if (in_window(k)) {
+    set_slot(static_cast<size_t>(k - base_), level);
+    return;
+  }
+  auto it = std::lower_bound(overflow_.begin(), overflow_.end(), k,
+    [](const auto& e, int64_t v) { return e.first < v; });
+  overflow_.insert(it, {k, level});
+}
+
+void PriceLadder::erase(Price price) {
+  const int64_t k = key(price);
+  if (in_window(k)) {
+    const size_t idx = static_cast<size_t>(k - base_);
+    if (!slots_[idx]) return;
+    clear_slot(idx);
+    --size_;
+    if (window_count_ == 0 && !overflow_.empty())
+      reanchor(overflow_.front().first - static_cast<int64_t>(slots_.size() / 4));
+    return;
+  }
+  auto it = std::lower_bound(overflow_.begin(), overflow_.end(), k,
+    [](const auto& e, int64_t v) { return e.first < v; });
+  if (it == overflow_.end() || it->first != k) return;
+  overflow_.erase(it);
+  --size_;
+}
+
+size_t PriceLadder::next_set(size_t from) const {
+  if (from >= slots_.size()) return npos;
+  size_t w = from / 64;
+  const uint64_t word = bits_[w] & (~uint64_t{0} << (from % 64));
+  if (word) return w * 64 + std::countr_zero(word);
+  for (size_t nw = w + 1; nw < bits_.size();) {
+    const size_t s = nw / 64;
+    const uint64_t sw = summary_[s] & (~uint64_t{0} << (nw % 64));
+    if (sw) {
+      w = s * 64 + std::countr_zero(sw);
+      return w * 64 + std::countr_zero(bits_[w]);
+    }
+    nw = (s + 1) * 64;
+  }
+  return npos;
+}
+
+size_t PriceLadder::prev_set(size_t before) const {
+  if (before == 0) return npos;
+  const size_t last = std::min(before, slots_.size()) - 1;
+  size_t w = last / 64;
+  const uint64_t word = bits_[w] & (~uint64_t{0} >> (63 - last % 64));
+  if (word) return w * 64 + 63 - std::countl_zero(word);
+  if (w == 0) return npos;
+  for (size_t pw = w - 1;;) {
+    const size_t s = pw / 64;
+    const uint64_t sw = summary_[s] & (~uint64_t{0} >> (63 - pw % 64));
+    if (sw) {
+      w = s * 64 + 63 - std::countl_zero(sw);
+      return w * 64 + 63 - std::countl_zero(bits_[w]);
+    }
+    if (s == 0) return npos;
+    pw = s * 64 - 1;
+  }
+}
+
+PriceLevel* PriceLadder::best() const {
+  const size_t idx = next_set(0);
+  return idx == npos ? nullptr : slots_[idx];
+}
+
+PriceLevel* PriceLadder::next_worse(Price price) const {
+  const int64_t k = key(price);
+  if (k < base_) return best();
+  if (in_window(k)) {
+    const size_t idx = next_set(static_cast<size_t>(k - base_) + 1);
+    if (idx != npos) return slots_[idx];
+    return overflow_.empty() ? nullptr : overflow_.front().second;
+  }
+  auto it = std::upper_bound(overflow_.begin(), overflow_.end(), k,
+    [](int64_t v, const auto& e) { return v < e.first; });
+  return it == overflow_.end() ? nullptr : it->second;
+}
+
+PriceLevel* PriceLadder::next_better(Price price) const {
+  const int64_t k = key(price);
+  if (k <= base_) return nullptr;
+  if (!in_window(k)) {
+    auto it = std::lower_bound(overflow_.begin(), overflow_.end(), k,
+      [](const auto& e, int64_t v) { return e.first < v; });
+    if (it != overflow_.begin()) return std::prev(it)->second;
+  }
+  const size_t idx = prev_set(static_cast<size_t>(std::min<int64_t>(
+      k - base_, static_cast<int64_t>(slots_.size()))));
+  return idx == npos ? nullptr : slots_[idx];
+}
+
+/// Slide the window to start at new_base, which must not exceed any stored
+/// key. Window levels spill to the front of the (sorted) overflow, then the
+/// overflow prefix that fits the new window is pulled back in.
+void PriceLadder::reanchor(int64_t new_base) {
+  if (window_count_ > 0) {
+    overflow_.insert(overflow_.begin(), window_count_, {0, nullptr});
+    size_t out = 0;
+    for (size_t w = 0; w < bits_.size(); ++w) {
+      uint64_t word = bits_[w];
+      while (word) {
+        const size_t idx = w * 64 + std::countr_zero(word);
+        overflow_[out++] = {base_ + static_cast<int64_t>(idx), slots_[idx]};
+        slots_[idx] = nullptr;
+        word &= word - 1;
+      }
+      bits_[w] = 0;
+    }
+    std::fill(summary_.begin(), summary_.end(), 0);
+    window_count_ = 0;
+  }
+  base_ = new_base;
+  size_t pulled = 0;
+  while (pulled < overflow_.size() && in_window(overflow_[pulled].first)) {
+    set_slot(static_cast<size_t>(overflow_[pulled].first - base_), overflow_[pulled].second);
+    ++pulled;
+  }
+  overflow_.erase(overflow_.begin(), overflow_.begin() + pulled);
+}
+
+} // namespace lumina
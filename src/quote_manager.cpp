@@ -0,0 +1,103 @@
+#include "lumina/quote_manager.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace lumina {
+
+namespace {
+constexpr int64_t NS_PER_SEC = 1'000'000'000;
+} // namespace
+
+void QuoteManager::set_options(const QuoteManagerOptions& options) {
+  options_ = options;
+  options_.tick_size = std::max<Price>(options_.tick_size, 1);
+  options_.min_requote_ticks = std::max<Price>(options_.min_requote_ticks, 1);
+  next_id_ = std::max(next_id_, options_.first_order_id);
+  interval_ns_ = options_.max_msgs_per_sec ? NS_PER_SEC / options_.max_msgs_per_sec : 0;
+}
+
+Price QuoteManager::round_to_tick(double price) const {
+  const double ticks = std::round(price / static_cast<double>(options_.tick_size));
+  return static_cast<Price>(ticks) * options_.tick_size;
+}
+
+/// Room for msgs more messages now: the budget allows one second's worth
+/// ahead of the clock.
+bool QuoteManager::admit(TimestampNs now_ns, int64_t msgs) {
+  if (interval_ns_ == 0) return true;
+  const TimestampNs tat = std::max(tat_ns_, now_ns);
+  if (tat + msgs * interval_ns_ - now_ns > NS_PER_SEC) return false;
+  tat_ns_ = tat;
+  return true;
+}
+
+void QuoteManager::charge(TimestampNs now_ns) {
+  if (interval_ns_ == 0) return;
+  tat_ns_ = std::max(tat_ns_, now_ns) + interval_ns_;
+}
+
+void QuoteManager::cancel(LiveQuote& q, TimestampNs now_ns) {
+  if (cancel_cb_) cancel_cb_(q.id);
+  charge(now_ns);
+  ++stats_.cancels;
+  q = {};
+}
+
+void QuoteManager::update(Side side, Price px, Qty qty, TimestampNs now_ns) {
+  const bool is_bid = side == Side::Buy;
+  LiveQuote& q = live_[is_bid ? 0 : 1];
+  if (qty <= 0) {
+    if (q.id) cancel(q, now_ns);
+    return;
+  }
+  if (q.id) {
+    const Price move = px > q.price ? px - q.price : q.price - px;
+    if (qty == q.qty && move < options_.min_requote_ticks * options_.tick_size) {
+      ++stats_.held;
+      return;
+    }
+    if (!admit(now_ns, replace_cb_ ? 1 : 2)) {
+      ++stats_.throttled;
+      return;
+    }
+    if (!replace_cb_) cancel(q, now_ns);
+  } else if (!admit(now_ns, 1)) {
+    ++stats_.throttled;
+    return;
+  }
+
+  const OrderId id = next_id_++;
+  if (q.id) {
+    if (replace_cb_) replace_cb_(q.id, id, px, qty, side, is_bid);
+    ++stats_.replaces;
+  } else {
+    if (order_cb_) order_cb_(id, px, qty, side, is_bid);
+    ++stats_.news;
+  }
+  charge(now_ns);
+  q = {id, px, qty};
+}
+
+void QuoteManager::cancel_all(TimestampNs now_ns) {
+  for (LiveQuote& q : live_)
+    if (q.id) cancel(q, now_ns);
+}
+
+LiveQuote* QuoteManager::find(OrderId id) {
+  for (LiveQuote& q : live_)
+    if (id != 0 && q.id == id) return &q;
+  return nullptr;
+}
+
+void QuoteManager::on_fill(OrderId id, Qty qty) {
+  LiveQuote* q = find(id);
+  if (!q) return;
+  q->qty -= qty;
+  if (q->qty <= 0) *q = {};
+}
+
+void QuoteManager::on_order_closed(OrderId id) {
+  if (LiveQuote* q = find(id)) *q = {};
+}
+
+} // namespace lumina
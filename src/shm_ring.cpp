@@ -0,0 +1,92 @@
+#include "lumina/shm_ring.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lumina {
+
+namespace {
+constexpr size_t align64(size_t n) { return (n + 63) & ~size_t{63}; }
+} // namespace
+
+size_t shm_ring_bytes(size_t capacity, size_t elem_size) {
+  return align64(sizeof(ShmRingHeader)) + SHM_MAX_CONSUMERS * sizeof(ShmConsumerSlot) +
+         capacity * elem_size;
+}
+
+ShmRegion& ShmRegion::operator=(ShmRegion&& o) noexcept {
+  if (this != &o) {
+    close();
+    data_ = o.data_;
+    size_ = o.size_;
+    o.data_ = nullptr;
+    o.size_ = 0;
+  }
+  return *this;
+}
+
+bool ShmRegion::create(const std::string& name, size_t bytes) {
+  close();
+  const int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd < 0) return false;
+  struct stat st {};
+  // Only a region nobody has sized yet is truncated; one of another size
+  // may be mapped by readers, which would fault on the pages cut away.
+  bool ok = ::fstat(fd, &st) == 0 &&
+            (static_cast<size_t>(st.st_size) == bytes ||
+             (st.st_size == 0 && ::ftruncate(fd, static_cast<off_t>(bytes)) == 0));
+  if (ok) {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ok = p != MAP_FAILED;
+    if (ok) {
+      data_ = p;
+      size_ = bytes;
+    }
+  }
+  ::close(fd);
+  return ok;
+}
+
+bool ShmRegion::open(const std::string& name) {
+  close();
+  const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) return false;
+  struct stat st {};
+  bool ok = ::fstat(fd, &st) == 0 && st.st_size > 0;
+  if (ok) {
+    const auto bytes = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ok = p != MAP_FAILED;
+    if (ok) {
+      data_ = p;
+      size_ = bytes;
+    }
+  }
+  ::close(fd);
+  return ok;
+}
+
+void ShmRegion::close() {
+  if (data_) ::munmap(data_, size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+bool ShmRegion::unlink(const std::string& name) {
+  return ::shm_unlink(name.c_str()) == 0;
+}
+
+namespace detail {
+
+int32_t current_pid() { return static_cast<int32_t>(::getpid()); }
+
+bool process_alive(int32_t pid) {
+  return ::kill(pid, 0) == 0 || errno == EPERM;
+}
+
+} // namespace detail
+
+} // namespace lumina
@@ -9,22 +9,80 @@ StrategyEngine::StrategyEngine(std::shared_ptr<MDRing> from_md,
   : from_md_(std::move(from_md)), as_(gamma, sigma, T_seconds), obi_(0.1), risk_(risk) {}
 
 void StrategyEngine::poll() {
-  MarketDataEvent ev;
-  while (from_md_->try_pop(ev)) {
-    double s = static_cast<double>(ev.mid);
-    double t_sec = (ev.ts_ns - session_start_ns_) / 1e9;
-    obi_.update(ev.bid_volume, ev.ask_volume);
-    double obi_skew = obi_.value();
-    last_r_ = as_.reservation_price(s, t_sec, 0.0);
-    double bid_off, ask_off;
-    as_.get_quotes(s, t_sec, 0.0, k_, obi_skew, bid_off, ask_off);
-    Price bid_price = static_cast<Price>(std::round(bid_off));
-    Price ask_price = static_cast<Price>(std::round(ask_off));
-    if (order_cb_ && risk_.check_order(bid_price, 100, Side::Buy))
-      order_cb_(0, bid_price, 100, Side::Buy, true);
-    if (order_cb_ && risk_.check_order(ask_price, 100, Side::Sell))
-      order_cb_(0, ask_price, 100, Side::Sell, false);
+  // Read events in place; each slot goes back to the producer once handled.
+  while (const MarketDataEvent* ev = from_md_->peek()) {
+    handle(*ev);
+    from_md_->release();
   }
+  // The parked state is newer than anything queued before it was parked;
+  // a later event that already went through the ring supersedes it.
+  MarketDataEvent parked;
+  if (conflation_ && conflation_->take(parked)) {
+    if (parked.seq > last_seq_) {
+      handle(parked);
+    } else {
+      conflated_ += parked.conflated + 1;
+    }
+  }
+}
+
+void StrategyEngine::handle(const MarketDataEvent& ev) {
+  ++events_;
+  conflated_ += ev.conflated;
+  if (ev.seq > last_seq_) last_seq_ = ev.seq;
+  on_event(ev);
+  scratch_.reset();
+}
+
+void StrategyEngine::on_event(const MarketDataEvent& ev) {
+  switch (ev.flag) {
+  case MDFlag::Trade:
+    last_trade_price_ = ev.trade.price;
+    break;
+  case MDFlag::BookUpdate:
+  case MDFlag::BestBidAsk:
+    break;
+  default:
+    return;
+  }
+  requote(ev);
+}
+
+double StrategyEngine::horizon_time(TimestampNs ts) {
+  if (!session_started_) {
+    session_start_ns_ = ts;
+    session_started_ = true;
+  }
+  if (ts <= session_start_ns_) return 0.0;
+  // Start a fresh horizon once the current one has run out; otherwise
+  // T - t stays <= 0 and sigma never reaches the quotes again.
+  const auto horizon = static_cast<TimestampNs>(as_.T() * 1e9);
+  TimestampNs elapsed = ts - session_start_ns_;
+  if (horizon > 0 && elapsed >= horizon) {
+    session_start_ns_ += elapsed / horizon * horizon;
+    elapsed %= horizon;
+  }
+  return elapsed / 1e9;
+}
+
+void StrategyEngine::requote(const MarketDataEvent& ev) {
+  double s = static_cast<double>(ev.mid());
+  double t_sec = horizon_time(ev.ts_ns);
+  vol_.update(ev.mid(), ev.ts_ns);
+  if (vol_.ready()) as_.set_sigma(vol_.sigma_per_sec() * s);
+  obi_.update(ev.bid_volume, ev.ask_volume);
+  double obi_skew = obi_.value();
+  last_r_ = as_.reservation_price(s, t_sec, 0.0);
+  double bid_off, ask_off;
+  as_.get_quotes(s, t_sec, 0.0, k_, obi_skew, bid_off, ask_off);
+  // Risk sees the exact prices sent; a side it refuses is pulled rather
+  // than left at a stale price.
+  const Price bid_price = quotes_.round_to_tick(bid_off);
+  const Price ask_price = quotes_.round_to_tick(ask_off);
+  const Qty bid_qty = risk_.check_order(bid_price, quote_qty_, Side::Buy) ? quote_qty_ : 0;
+  const Qty ask_qty = risk_.check_order(ask_price, quote_qty_, Side::Sell) ? quote_qty_ : 0;
+  quotes_.update(Side::Buy, bid_price, bid_qty, ev.ts_ns);
+  quotes_.update(Side::Sell, ask_price, ask_qty, ev.ts_ns);
 }
 
 } // namespace lumina
@@ -0,0 +1,359 @@
+#include "lumina/udp_feed.hpp"
+#include "lumina/itch_feed.hpp"
+#include "lumina/thread_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace lumina {
+
+namespace {
+constexpr size_t MAX_RECV_BATCH = 256;
+constexpr size_t MAX_REORDER_WINDOW = 4096;
+// Smallest record is a delete, which bounds the messages one packet holds.
+constexpr size_t MAX_MSGS_PER_PACKET =
+    (FEED_MAX_PAYLOAD - sizeof(FeedPacketHeader)) / sizeof(ItchDeleteOrder);
+
+bool parse_addr(const std::string& text, in_addr& out) {
+  return ::inet_pton(AF_INET, text.c_str(), &out) == 1;
+}
+
+/// Non-blocking socket bound to the line's port and address, joined to the
+/// group if it is multicast. -1 on failure.
+int open_rx_socket(const UdpLine& line, int rcvbuf_bytes) {
+  in_addr group{}, iface{};
+  if (!parse_addr(line.group, group) || !parse_addr(line.iface, iface)) return -1;
+  const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+  if (fd < 0) return -1;
+  const int one = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf_bytes, sizeof(rcvbuf_bytes));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(line.port);
+  addr.sin_addr = group;  // binding the group keeps other groups on this port out
+  bool ok = ::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+  if (ok && IN_MULTICAST(ntohl(group.s_addr))) {
+    ip_mreq mreq{};
+    mreq.imr_multiaddr = group;
+    mreq.imr_interface = iface;
+    ok = ::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0;
+  }
+  if (!ok) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// The payload is exactly count well-formed records numbered from seq.
+/// Checked before a packet is accepted, so a damaged copy is refused and
+/// the sequence waits for the other line (or gives the range up) instead of
+/// advancing past messages that never decode.
+/// The length checks ItchDecoder::decode applies to a record with left
+/// bytes remaining.
+bool record_fits(const ItchHeader& h, size_t left) {
+  return h.length >= sizeof(ItchHeader) && h.length >= min_len(h.type) && h.length <= left &&
+         h.length % 8 == 0;
+}
+
+bool records_intact(const char* records, size_t bytes, uint64_t seq, uint16_t count) {
+  size_t pos = 0;
+  uint64_t n = 0;
+  while (pos < bytes) {
+    if (bytes - pos < sizeof(ItchHeader)) return false;
+    ItchHeader h;
+    std::memcpy(&h, records + pos, sizeof(h));
+    if (!record_fits(h, bytes - pos) || h.seq != seq + n) return false;
+    pos += h.length;
+    ++n;
+  }
+  return n == count;
+}
+} // namespace
+
+// ---- UdpFeedSource ----
+
+bool UdpFeedSource::open(const UdpFeedOptions& options) {
+  close();
+  options_ = options;
+  options_.recv_batch = std::clamp<size_t>(options_.recv_batch, 1, MAX_RECV_BATCH);
+  options_.reorder_window = std::clamp<size_t>(options_.reorder_window, 1, MAX_REORDER_WINDOW);
+  const UdpLine* lines[2] = {&options_.a, &options_.b};
+  for (int i = 0; i < 2; ++i) {
+    if (lines[i]->port == 0) continue;
+    fds_[i] = open_rx_socket(*lines[i], options_.rcvbuf_bytes);
+    if (fds_[i] < 0) {
+      close();
+      return false;
+    }
+  }
+  if (fds_[0] < 0 && fds_[1] < 0) return false;
+
+  recv_buf_.assign(options_.recv_batch * FEED_RECV_BUFFER / sizeof(uint64_t), 0);
+  pending_.assign(options_.reorder_window, Pending{});
+  for (Pending& p : pending_) p.data.resize(FEED_RECV_BUFFER / sizeof(uint64_t));
+  pending_count_ = 0;
+  gap_since_ns_ = 0;
+  staged_.resize((2 * options_.recv_batch + options_.reorder_window) * MAX_MSGS_PER_PACKET);
+  staged_head_ = staged_tail_ = 0;
+  next_seq_ = options_.first_seq;
+  synced_ = options_.first_seq != 0;
+  skipped_ = {};
+  skipped_next_ = 0;
+  stats_ = {};
+  return true;
+}
+
+void UdpFeedSource::close() {
+  for (int& fd : fds_) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+}
+
+size_t UdpFeedSource::poll(FeedMessage* out, size_t max) {
+  if (staged_head_ == staged_tail_) {
+    staged_head_ = staged_tail_ = 0;
+    for (int line = 0; line < 2; ++line)
+      if (fds_[line] >= 0) receive(line);
+    if (pending_count_ && monotonic_ns() - gap_since_ns_ >= options_.gap_timeout_ns)
+      give_up_gap();
+  }
+  const size_t n = std::min(max, staged_tail_ - staged_head_);
+  std::copy_n(staged_.data() + staged_head_, n, out);
+  staged_head_ += n;
+  return n;
+}
+
+void UdpFeedSource::receive(int line) {
+  mmsghdr msgs[MAX_RECV_BATCH];
+  iovec iov[MAX_RECV_BATCH];
+  char* base = reinterpret_cast<char*>(recv_buf_.data());
+  const size_t batch = options_.recv_batch;
+  for (size_t i = 0; i < batch; ++i) {
+    iov[i] = {base + i * FEED_RECV_BUFFER, FEED_RECV_BUFFER};
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  const int got = ::recvmmsg(fds_[line], msgs, static_cast<unsigned>(batch), MSG_DONTWAIT,
+                             nullptr);
+  for (int i = 0; i < got; ++i) {
+    ++stats_.packets[line];
+    if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      ++stats_.malformed;
+      continue;
+    }
+    on_packet(line, base + i * FEED_RECV_BUFFER, msgs[i].msg_len);
+  }
+}
+
+void UdpFeedSource::on_packet(int line, const char* data, size_t bytes) {
+  if (bytes < sizeof(FeedPacketHeader) || bytes > FEED_MAX_PAYLOAD || bytes % 8 != 0) {
+    ++stats_.malformed;
+    return;
+  }
+  FeedPacketHeader h;
+  std::memcpy(&h, data, sizeof(h));
+  if (h.count == 0) return;  // heartbeat
+  const char* records = data + sizeof(FeedPacketHeader);
+  const size_t record_bytes = bytes - sizeof(FeedPacketHeader);
+  if (!records_intact(records, record_bytes, h.seq, h.count)) {
+    ++stats_.malformed;
+    return;
+  }
+  const uint64_t end = h.seq + h.count;
+  if (!synced_) {
+    next_seq_ = h.seq;
+    synced_ = true;
+  }
+  if (end <= next_seq_) {
+    ++(in_skipped(h.seq, end) ? stats_.late : stats_.duplicates);
+    return;
+  }
+  if (h.seq <= next_seq_) {
+    deliver(line, records, record_bytes, h.seq, h.count);
+    drain_pending();
+    return;
+  }
+  // Ahead of the expected sequence: hold it until the gap fills.
+  for (const Pending& p : pending_) {
+    if (p.used && p.seq == h.seq) {
+      ++stats_.duplicates;
+      return;
+    }
+  }
+  if (pending_count_ == pending_.size()) {
+    give_up_gap();
+    on_packet(line, data, bytes);
+    return;
+  }
+  Pending& slot = *std::find_if(pending_.begin(), pending_.end(),
+                                [](const Pending& p) { return !p.used; });
+  slot.seq = h.seq;
+  slot.count = h.count;
+  slot.line = static_cast<uint8_t>(line);
+  slot.used = true;
+  slot.bytes = record_bytes;
+  std::memcpy(slot.data.data(), records, record_bytes);
+  if (pending_count_++ == 0) gap_since_ns_ = monotonic_ns();
+}
+
+/// Decode a packet's records into the staging area, skipping any the
+/// other line already delivered, and advance the expected sequence.
+void UdpFeedSource::deliver(int line, const char* records, size_t bytes, uint64_t seq,
+                            uint16_t count) {
+  ++stats_.first[line];
+  ItchDecoder dec = ItchDecoder::records(records, bytes);
+  FeedMessage* first = staged_.data() + staged_tail_;
+  const size_t n = dec.decode(first, staged_.size() - staged_tail_);
+  FeedMessage* kept = std::remove_if(first, first + n, [this](const FeedMessage& m) {
+    return m.seq < next_seq_;
+  });
+  const auto added = static_cast<size_t>(kept - first);
+  staged_tail_ += added;
+  stats_.messages += added;
+  next_seq_ = std::max(next_seq_, seq + count);
+}
+
+void UdpFeedSource::drain_pending() {
+  while (Pending* p = oldest_pending()) {
+    if (p->seq > next_seq_) break;
+    p->used = false;
+    --pending_count_;
+    if (p->seq + p->count <= next_seq_) {
+      ++stats_.duplicates;
+      continue;
+    }
+    ++stats_.reordered;
+    deliver(p->line, reinterpret_cast<const char*>(p->data.data()), p->bytes, p->seq,
+            p->count);
+  }
+  gap_since_ns_ = pending_count_ ? monotonic_ns() : 0;
+}
+
+void UdpFeedSource::give_up_gap() {
+  Pending* p = oldest_pending();
+  if (!p) return;
+  const Range gap{next_seq_, p->seq};
+  ++stats_.gaps;
+  stats_.gap_messages += gap.to - gap.from;
+  skipped_[skipped_next_++ % SKIPPED_RANGES] = gap;
+  next_seq_ = gap.to;
+  if (recovery_cb_) recovery_cb_(gap.from, gap.to);
+  drain_pending();
+}
+
+UdpFeedSource::Pending* UdpFeedSource::oldest_pending() {
+  if (pending_count_ == 0) return nullptr;
+  Pending* oldest = nullptr;
+  for (Pending& p : pending_)
+    if (p.used && (!oldest || p.seq < oldest->seq)) oldest = &p;
+  return oldest;
+}
+
+bool UdpFeedSource::in_skipped(uint64_t seq, uint64_t end) const {
+  for (const Range& r : skipped_)
+    if (seq < r.to && end > r.from) return true;
+  return false;
+}
+
+// ---- UdpFeedPublisher ----
+
+bool UdpFeedPublisher::open(const UdpLine& a, const UdpLine& b) {
+  close();
+  const UdpLine* lines[2] = {&a, &b};
+  for (int i = 0; i < 2; ++i) {
+    if (lines[i]->port == 0) continue;
+    in_addr group{}, iface{};
+    if (!parse_addr(lines[i]->group, group) || !parse_addr(lines[i]->iface, iface)) {
+      close();
+      return false;
+    }
+    fds_[i] = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fds_[i] < 0) {
+      close();
+      return false;
+    }
+    const unsigned char loop = 1, ttl = 1;
+    ::setsockopt(fds_[i], IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+    ::setsockopt(fds_[i], IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    ::setsockopt(fds_[i], IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    addr_[i] = group.s_addr;
+    port_[i] = htons(lines[i]->port);
+  }
+  return fds_[0] >= 0;
+}
+
+void UdpFeedPublisher::close() {
+  for (int& fd : fds_) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+}
+
+bool UdpFeedPublisher::send(int line, uint64_t seq, uint16_t count, const char* records,
+                            size_t bytes) {
+  if (fds_[line] < 0 || sizeof(FeedPacketHeader) + bytes > FEED_MAX_PAYLOAD) return false;
+  alignas(8) char packet[FEED_MAX_PAYLOAD];
+  FeedPacketHeader h{};
+  h.seq = seq;
+  h.count = count;
+  std::memcpy(packet, &h, sizeof(h));
+  std::memcpy(packet + sizeof(h), records, bytes);
+  sockaddr_in dest{};
+  dest.sin_family = AF_INET;
+  dest.sin_port = port_[line];
+  dest.sin_addr.s_addr = addr_[line];
+  const size_t len = sizeof(h) + bytes;
+  return ::sendto(fds_[line], packet, len, 0, reinterpret_cast<const sockaddr*>(&dest),
+                  sizeof(dest)) == static_cast<ssize_t>(len);
+}
+
+uint64_t UdpFeedPublisher::replay(const char* capture, size_t size, double msgs_per_sec,
+                                  size_t max_per_packet) {
+  if (!ItchDecoder(capture, size).valid()) return 0;
+  constexpr size_t room = FEED_MAX_PAYLOAD - sizeof(FeedPacketHeader);
+  max_per_packet = std::clamp<size_t>(max_per_packet, 1, UINT16_MAX);
+  const TimestampNs start = monotonic_ns();
+  uint64_t sent = 0;
+  size_t pos = sizeof(ItchFileHeader);
+  bool stop = false;
+  while (!stop && pos + sizeof(ItchHeader) <= size) {
+    const size_t first = pos;
+    uint64_t seq = 0;
+    uint16_t count = 0;
+    while (count < max_per_packet && pos + sizeof(ItchHeader) <= size) {
+      ItchHeader h;
+      std::memcpy(&h, capture + pos, sizeof(h));
+      // A damaged record, or one no packet can carry, ends the replay
+      // after the records before it go out.
+      if (!record_fits(h, size - pos) || h.length > room) {
+        stop = true;
+        break;
+      }
+      if (pos + h.length - first > room) break;
+      if (count++ == 0) seq = h.seq;
+      pos += h.length;
+    }
+    if (count == 0) break;
+    for (int line = 0; line < 2; ++line)
+      if (fds_[line] >= 0) send(line, seq, count, capture + first, pos - first);
+    sent += count;
+    if (msgs_per_sec > 0) {
+      const auto due = start + static_cast<TimestampNs>(static_cast<double>(sent) * 1e9 /
+                                                        msgs_per_sec);
+      const TimestampNs now = monotonic_ns();
+      if (due > now) std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+    }
+  }
+  return sent;
+}
+
+} // namespace lumina
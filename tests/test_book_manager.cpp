@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "lumina/book_manager.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+using namespace lumina;
+
+TEST(BookManager, InternsSymbolsDensely) {
+  BookManager mgr({0, 1});
+  ASSERT_EQ(mgr.add_symbol("AAPL"), 0u);
+  ASSERT_EQ(mgr.add_symbol("MSFT"), 1u);
+  ASSERT_EQ(mgr.add_symbol("AAPL"), 0u);
+  ASSERT_EQ(mgr.book_count(), 2u);
+  ASSERT_EQ(mgr.symbols().find("MSFT"), 1u);
+  ASSERT_EQ(mgr.symbols().find("GOOG"), INVALID_SYMBOL);
+  ASSERT_EQ(mgr.symbols().name(1), "MSFT");
+  ASSERT_THROW(mgr.add_symbol("THIS_IS_WAY_TOO_LONG"), std::invalid_argument);
+}
+
+TEST(BookManager, ShardsOwnDisjointBooks) {
+  BookManager mgr({0, 0, 0}, 1024);
+  for (int i = 0; i < 10; ++i) mgr.add_symbol("S" + std::to_string(i));
+  size_t total = 0;
+  for (size_t s = 0; s < mgr.shard_count(); ++s) {
+    for (SymbolId id : mgr.shard_symbols(s)) ASSERT_EQ(mgr.shard_of(id), s);
+    total += mgr.shard_symbols(s).size();
+  }
+  ASSERT_EQ(total, 10u);
+  std::atomic<int> done{0};
+  mgr.start([&](size_t shard) {
+    for (SymbolId id : mgr.shard_symbols(shard))
+      mgr.book(id).add_order(1, 100 + static_cast<Price>(id), 10, Side::Buy);
+    done.fetch_add(1);
+  });
+  mgr.stop();
+  ASSERT_EQ(done.load(), 3);
+  for (SymbolId id = 0; id < 10; ++id)
+    ASSERT_EQ(mgr.book(id).best_bid(), 100 + static_cast<Price>(id));
+}
+
+TEST(BookManager, BooksAreBuiltOnShardThreads) {
+  BookManager mgr({0, 0}, 256);
+  mgr.add_symbol("AAPL");
+  mgr.add_symbol("MSFT");
+  mgr.build();
+  ASSERT_TRUE(mgr.book(0).add_order(1, 100, 10, Side::Buy));
+  ASSERT_EQ(mgr.book(1).best_bid(), 0);
+  // A symbol added after build() gets its book when the shards start;
+  // books already built keep their state.
+  const SymbolId goog = mgr.add_symbol("GOOG");
+  std::atomic<int> built{0};
+  mgr.start([&](size_t shard) {
+    for (SymbolId id : mgr.shard_symbols(shard)) {
+      mgr.book(id).add_order(2, 101, 5, Side::Buy);
+      built.fetch_add(1);
+    }
+  });
+  mgr.stop();
+  ASSERT_EQ(built.load(), 3);
+  ASSERT_EQ(mgr.book(goog).best_bid(), 101);
+  ASSERT_EQ(mgr.book(0).bid_volume(), 15);
+}
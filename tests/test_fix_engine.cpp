@@ -31,3 +31,12 @@ TEST(FixEngine, BuildNewOrderSingle) {
   EXPECT_TRUE(msg.find("11=1") != std::string::npos);
   EXPECT_TRUE(msg.find("44=20000") != std::string::npos);
 }
+
+TEST(FixEngine, ArenaBuildersMatchStringBuilders) {
+  FixEngine fix;
+  ScratchArena scratch(1024);
+  EXPECT_EQ(fix.build_new_order_single(scratch, 42, "MSFT", Side::Sell, 7, -5),
+            fix.build_new_order_single(42, "MSFT", Side::Sell, 7, -5));
+  EXPECT_EQ(fix.build_cancel_request(scratch, 43, 42), fix.build_cancel_request(43, 42));
+  EXPECT_EQ(fix.build_cancel_request(43, 42), "35=F|11=43|41=42|");
+}
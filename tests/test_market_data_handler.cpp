@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+#include "lumina/conflation.hpp"
+#include "lumina/market_data_handler.hpp"
+#include "lumina/strategy_engine.hpp"
+#include "lumina/top_of_book.hpp"
+#include <thread>
+#include <vector>
+
+using namespace lumina;
+
+namespace {
+/// Hands out a fixed message list in small batches, then finishes.
+class VectorFeed : public FeedSource {
+public:
+  explicit VectorFeed(std::vector<FeedMessage> msgs, size_t per_poll = 3)
+    : msgs_(std::move(msgs)), per_poll_(per_poll) {}
+  size_t poll(FeedMessage* out, size_t max) override {
+    const size_t n = std::min({max, per_poll_, msgs_.size() - next_});
+    for (size_t i = 0; i < n; ++i) out[i] = msgs_[next_ + i];
+    next_ += n;
+    return n;
+  }
+  bool finished() const override { return next_ == msgs_.size(); }
+
+private:
+  std::vector<FeedMessage> msgs_;
+  size_t per_poll_;
+  size_t next_{0};
+};
+
+[[maybe_unused]] FeedMessage order_msg(FeedMsgType type, OrderId id, Side side, Price price,
+                                       Qty qty, uint64_t seq) {
+  FeedMessage m;
+  m.type = type;
+  m.id = id;
+  m.side = side;
+  m.price = price;
+  m.qty = qty;
+  m.seq = seq;
+  m.ts_ns = static_cast<TimestampNs>(seq) * 100;
+  return m;
+}
+} // namespace
+
+TEST(TopOfBook, PublishAssignsSequenceAndMid) {
+  TopOfBookCell cell;
+  ASSERT_EQ(cell.read().seq, 0u);
+  TopOfBook top;
+  top.bid = 100;
+  top.ask = 104;
+  top.bid_qty = 5;
+  top.ask_qty = 7;
+  top.ts_ns = 42;
+  cell.publish(top);
+  TopOfBook got = cell.read();
+  ASSERT_EQ(got.seq, 1u);
+  ASSERT_EQ(got.mid, 102);
+  ASSERT_EQ(got.ask_qty, 7);
+  ASSERT_EQ(got.ts_ns, 42);
+  top.ask = 0;
+  cell.publish(top);
+  got = cell.read();
+  ASSERT_EQ(got.seq, 2u);
+  ASSERT_EQ(got.mid, 100);  // one-sided
+}
+
+TEST(TopOfBook, ReaderNeverSeesTornRecord) {
+  TopOfBookCell cell;
+  constexpr int64_t kUpdates = 200000;
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    TopOfBook top;
+    for (int64_t i = 1; i <= kUpdates; ++i) {
+      top.bid = i;
+      top.ask = i + 1;
+      top.bid_qty = i * 2;
+      top.ask_qty = i * 3;
+      top.bid_volume = i * 4;
+      top.ask_volume = i * 5;
+      top.ts_ns = i;
+      cell.publish(top);
+    }
+    done.store(true);
+  });
+  uint64_t last_seq = 0;
+  while (!done.load()) {
+    const TopOfBook t = cell.read();
+    ASSERT_GE(t.seq, last_seq);
+    last_seq = t.seq;
+    if (t.seq == 0) continue;
+    ASSERT_EQ(static_cast<uint64_t>(t.bid), t.seq);
+    ASSERT_EQ(t.ask, t.bid + 1);
+    ASSERT_EQ(t.bid_qty, t.bid * 2);
+    ASSERT_EQ(t.ask_qty, t.bid * 3);
+    ASSERT_EQ(t.bid_volume, t.bid * 4);
+    ASSERT_EQ(t.ask_volume, t.bid * 5);
+    ASSERT_EQ(t.ts_ns, t.bid);
+  }
+  writer.join();
+  ASSERT_EQ(cell.read().seq, static_cast<uint64_t>(kUpdates));
+}
+
+TEST(MarketDataHandler, PublishesTopOfBookPerUpdate) {
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  auto handler = std::make_unique<MarketDataHandler>(ring);
+  handler->on_trade(100, 1, 7);
+  const TopOfBook top = handler->top_of_book().read();
+  ASSERT_EQ(top.seq, 1u);
+  ASSERT_EQ(top.ts_ns, 7);
+}
+
+TEST(MarketDataHandler, BookUpdateAppliesLevelDeltas) {
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  MarketDataHandler handler(ring);
+  handler.on_book_update(Side::Buy, 100, 10, true, 1);
+  handler.on_book_update(Side::Sell, 103, 4, true, 2);
+  handler.on_book_update(Side::Buy, 101, 2, true, 3);
+  handler.on_book_update(Side::Buy, 100, 3, false, 4);
+  handler.on_book_update(Side::Buy, 101, 2, false, 5);  // level deleted
+
+  const MDBook& book = handler.order_book();
+  EXPECT_EQ(book.best_bid(), 100);
+  EXPECT_EQ(book.level_qty(Side::Buy, 100), 7);
+  EXPECT_EQ(book.level_qty(Side::Buy, 101), 0);
+  EXPECT_EQ(book.bid_volume(), 7);
+  EXPECT_EQ(book.best_ask(), 103);
+
+  MarketDataEvent ev;
+  for (uint64_t seq = 1; seq <= 4; ++seq) {
+    ASSERT_TRUE(ring->try_pop(ev));
+    EXPECT_EQ(ev.seq, seq);
+  }
+  EXPECT_EQ(ev.flag, MDFlag::BookUpdate);
+  EXPECT_EQ(ev.side, Side::Buy);
+  EXPECT_EQ(ev.level.delta, -3);
+  EXPECT_EQ(ev.level.level_qty, 7);
+  EXPECT_EQ(ev.bid, 101);
+  EXPECT_EQ(ev.bid_volume, 9);  // side total: 101 x 2 and 100 x 7
+  ASSERT_TRUE(ring->try_pop(ev));
+  EXPECT_EQ(ev.seq, 5u);
+  EXPECT_EQ(ev.ts_ns, 5);
+  EXPECT_EQ(ev.level.level_qty, 0);
+  EXPECT_EQ(ev.bid, 100);
+  EXPECT_EQ(ev.bid_volume, 7);
+  EXPECT_EQ(ev.ask, 103);
+  EXPECT_EQ(ev.mid(), 101);
+  // Best-level sizes are published on the top-of-book cell.
+  const TopOfBook top = handler.top_of_book().read();
+  EXPECT_EQ(top.seq, ev.seq);
+  EXPECT_EQ(top.bid_qty, 7);
+  EXPECT_EQ(top.ask_qty, 4);
+
+  // Removals publish what was applied: nothing at an empty price, and no
+  // more than the level held.
+  handler.on_book_update(Side::Sell, 100, 5, false, 6);
+  EXPECT_FALSE(ring->try_pop(ev));
+  handler.on_book_update(Side::Sell, 103, 10, false, 7);
+  ASSERT_TRUE(ring->try_pop(ev));
+  EXPECT_EQ(ev.seq, 6u);
+  EXPECT_EQ(ev.level.delta, -4);
+  EXPECT_EQ(ev.level.level_qty, 0);
+  EXPECT_EQ(ev.ask, 0);
+  EXPECT_EQ(book.best_ask(), 0);
+}
+
+TEST(Conflation, SlotKeepsLatestAndCountsMerged) {
+  ConflationSlot slot;
+  MarketDataEvent ev{};
+  EXPECT_FALSE(slot.take(ev));
+  for (uint64_t seq = 1; seq <= 3; ++seq) {
+    ev.seq = seq;
+    ev.bid = 100 + static_cast<Price>(seq);
+    slot.park(ev);
+  }
+  MarketDataEvent got{};
+  ASSERT_TRUE(slot.take(got));
+  EXPECT_EQ(got.seq, 3u);
+  EXPECT_EQ(got.bid, 103);
+  EXPECT_EQ(got.conflated, 2u);
+  EXPECT_FALSE(slot.take(got));
+  slot.park(ev);
+  ASSERT_TRUE(slot.take(got));
+  EXPECT_EQ(got.conflated, 0u);
+  EXPECT_EQ(slot.parked(), 4u);
+}
+
+TEST(MarketDataHandler, ConflatesBookUpdatesWhileStrategyLags) {
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  auto slot = std::make_shared<ConflationSlot>();
+  MarketDataHandler handler(ring);
+  handler.set_conflation(slot, 4);
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine strategy(ring, 0.1, 0.02, 1.0, risk);
+  strategy.set_conflation(slot);
+
+  // Seq 1-4 queue, 5-6 park, the trade (7) still queues, 8-10 park.
+  for (Price px = 100; px < 106; ++px) handler.on_book_update(Side::Buy, px, 1, true);
+  handler.on_trade(105, 1, 0);
+  for (Price px = 106; px < 109; ++px) handler.on_book_update(Side::Buy, px, 1, true);
+  EXPECT_EQ(ring->size(), 5u);
+  EXPECT_EQ(handler.loop_stats().conflated, 5u);
+
+  strategy.poll();
+  EXPECT_EQ(strategy.events(), 6u);  // 1-4, the trade, then the latest state (10)
+  EXPECT_EQ(strategy.conflated_events(), 4u);
+  EXPECT_EQ(strategy.dropped_events(), 0u);
+
+  // A parked state older than a queued trade is superseded, not replayed.
+  for (Price px = 110; px < 115; ++px) handler.on_book_update(Side::Sell, px, 1, true);
+  handler.on_trade(110, 1, 0);
+  strategy.poll();
+  EXPECT_EQ(strategy.events(), 11u);
+  EXPECT_EQ(strategy.conflated_events(), 5u);
+  EXPECT_EQ(strategy.dropped_events(), 0u);
+  EXPECT_EQ(handler.loop_stats().dropped, 0u);
+}
+
+TEST(MarketDataHandler, ParkedStateIsTopOfBookEvent) {
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  auto slot = std::make_shared<ConflationSlot>();
+  MarketDataHandler handler(ring);
+  handler.set_conflation(slot, 0);  // park every book update
+  handler.on_book_update(Side::Buy, 100, 5, true, 1);
+  handler.on_book_update(Side::Sell, 104, 3, true, 2);
+  handler.on_trade(102, 2, 3);
+  EXPECT_EQ(ring->size(), 1u);
+
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine strategy(ring, 0.1, 0.02, 1.0, risk);
+  MarketDataEvent ev;
+  ASSERT_TRUE(slot->take(ev));
+  EXPECT_EQ(ev.flag, MDFlag::BestBidAsk);
+  EXPECT_EQ(ev.seq, 2u);
+  EXPECT_EQ(ev.conflated, 1u);
+  EXPECT_EQ(ev.top.bid_qty, 5);
+  EXPECT_EQ(ev.top.ask_qty, 3);
+  EXPECT_EQ(ev.mid(), 102);
+
+  strategy.poll();
+  EXPECT_EQ(strategy.events(), 1u);
+  EXPECT_EQ(strategy.last_trade_price(), 102);
+}
+
+TEST(MarketDataHandler, FullRingDropsAreCounted) {
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  MarketDataHandler handler(ring);
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine strategy(ring, 0.1, 0.02, 1.0, risk);
+  for (size_t i = 0; i < MD_RING_SIZE + 2; ++i) handler.on_trade(100, 1, 0);
+  handler.on_book_update(Side::Buy, 99, 1, true);
+  EXPECT_EQ(handler.loop_stats().dropped, 3u);
+  strategy.poll();
+  handler.on_trade(100, 1, 0);
+  strategy.poll();
+  EXPECT_EQ(strategy.events(), MD_RING_SIZE + 1);
+  EXPECT_EQ(strategy.dropped_events(), 3u);
+  EXPECT_EQ(strategy.conflated_events(), 0u);
+}
+
+#if !defined(LUMINA_MBP_BOOK)
+TEST(MarketDataHandler, EventLoopAppliesOrderFeed) {
+  std::vector<FeedMessage> msgs = {
+    order_msg(FeedMsgType::AddOrder, 1, Side::Buy, 100, 10, 1),
+    order_msg(FeedMsgType::AddOrder, 2, Side::Buy, 99, 5, 2),
+    order_msg(FeedMsgType::AddOrder, 3, Side::Sell, 102, 8, 3),
+    order_msg(FeedMsgType::CancelOrder, 1, Side::Buy, 0, 4, 4),
+    order_msg(FeedMsgType::ExecuteOrder, 3, Side::Sell, 0, 3, 5),
+    order_msg(FeedMsgType::DeleteOrder, 2, Side::Buy, 0, 0, 6),
+  };
+  FeedMessage replace = order_msg(FeedMsgType::ReplaceOrder, 3, Side::Sell, 101, 7, 7);
+  replace.new_id = 4;
+  msgs.push_back(replace);
+
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  MDHandlerOptions options;
+  options.core = NO_CORE_PIN;
+  options.idle = IdleStrategy::spin_yield();
+  MarketDataHandler handler(ring, options);
+  VectorFeed feed(msgs);
+  handler.set_feed(&feed);
+  handler.start();
+  while (!handler.feed_finished()) std::this_thread::yield();
+  handler.stop();
+
+  const MDBook& book = handler.order_book();
+  EXPECT_EQ(book.best_bid(), 100);
+  EXPECT_EQ(book.best_bid_level().total_qty, 6);
+  EXPECT_EQ(book.bid_volume(), 6);
+  EXPECT_EQ(book.best_ask(), 101);
+  EXPECT_EQ(book.ask_volume(), 7);
+  EXPECT_EQ(handler.last_seq(), 7u);
+
+  const MDLoopStats stats = handler.loop_stats();
+  EXPECT_EQ(stats.messages, msgs.size());
+  EXPECT_EQ(stats.batches, 3u);
+  EXPECT_LE(stats.max_batch_ns, stats.busy_ns);
+
+  // One event per level change (the replace moves qty between two levels);
+  // the execution is published as a trade carrying its level change.
+  size_t events = 0;
+  MarketDataEvent ev;
+  while (ring->try_pop(ev)) {
+    ++events;
+    EXPECT_EQ(ev.seq, events);
+    if (events == 4) {
+      EXPECT_EQ(ev.flag, MDFlag::BookUpdate);
+      EXPECT_EQ(ev.level.price, 100);
+      EXPECT_EQ(ev.level.delta, -4);
+      EXPECT_EQ(ev.level.level_qty, 6);
+    }
+    if (events == 5) {
+      EXPECT_EQ(ev.flag, MDFlag::Trade);
+      EXPECT_EQ(ev.trade.price, 102);
+      EXPECT_EQ(ev.trade.qty, 3);
+      EXPECT_EQ(ev.trade.level_qty, 5);
+      EXPECT_EQ(ev.ts_ns, 500);
+    }
+  }
+  EXPECT_EQ(events, msgs.size() + 1);
+  EXPECT_EQ(handler.top_of_book().read().ask, 101);
+}
+
+TEST(MarketDataHandler, PollFeedOnCallerThreadSkipsUnknownOrders) {
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  MarketDataHandler handler(ring);
+  VectorFeed feed({order_msg(FeedMsgType::AddOrder, 1, Side::Sell, 105, 2, 1),
+                   order_msg(FeedMsgType::ExecuteOrder, 9, Side::Sell, 0, 1, 2),
+                   order_msg(FeedMsgType::CancelOrder, 9, Side::Sell, 0, 1, 3)},
+                  8);
+  handler.set_feed(&feed);
+  EXPECT_EQ(handler.poll_feed(), 3u);
+  EXPECT_EQ(handler.poll_feed(), 0u);
+  EXPECT_TRUE(feed.finished());
+  EXPECT_EQ(ring->size(), 1u);
+  EXPECT_EQ(handler.order_book().best_ask(), 105);
+}
+#endif
@@ -1,5 +1,14 @@
 #include <gtest/gtest.h>
 #include "lumina/memory_pool.hpp"
+#include "lumina/huge_arena.hpp"
+#include "lumina/order_book.hpp"
+#include "lumina/ring_buffer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
 
 using namespace lumina;
 
@@ -19,6 +28,92 @@ TEST(MemoryPool, TemplatePoolAllocFree) {
     ASSERT_NE(pool.allocate(), nullptr);
 }
 
+TEST(MemoryPool, StatsTrackUseAndHighWater) {
+  MemoryPool<uint64_t, 256, 8> pool;
+  std::vector<uint64_t*> ptrs;
+  for (int i = 0; i < 100; ++i) ptrs.push_back(pool.allocate());
+  ASSERT_EQ(pool.size_used(), 100u);
+  for (int i = 0; i < 60; ++i) {
+    pool.deallocate(ptrs.back());
+    ptrs.pop_back();
+  }
+  ASSERT_EQ(pool.size_used(), 40u);
+  // Within one magazine of the true peak.
+  ASSERT_GE(pool.high_water(), 100u);
+  ASSERT_LE(pool.high_water(), 100u + 8);
+  pool.drain_local();
+  for (auto* p : ptrs) pool.deallocate(p);
+  ASSERT_EQ(pool.size_used(), 0u);
+
+  MemoryPool<uint64_t, 16, 0> direct;  // no magazines
+  for (int i = 0; i < 16; ++i) ASSERT_NE(direct.allocate(), nullptr);
+  ASSERT_EQ(direct.allocate(), nullptr);
+  ASSERT_EQ(direct.size_used(), 16u);
+  ASSERT_EQ(direct.high_water(), 16u);
+}
+
+// Threads allocate random bursts, stamp each block with an owner token,
+// hand half of them to a neighbour to free (cross-thread frees), and check
+// the stamps on free. A block handed out twice (ABA on the free list) would
+// have its stamp overwritten.
+TEST(MemoryPool, ConcurrentAllocFreeNoDoubleHandout) {
+  constexpr size_t kCap = 4096;
+  constexpr int kThreads = 8;
+  constexpr int kRounds = 2000;
+  using Pool = MemoryPool<uint64_t, kCap, 16>;
+  auto pool = std::make_unique<Pool>();
+  std::vector<std::atomic<uint64_t*>> handoff(kThreads);
+  for (auto& h : handoff) h.store(nullptr);
+  std::atomic<int> bad{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::vector<std::pair<uint64_t*, uint64_t>> held;
+      for (int round = 0; round < kRounds; ++round) {
+        const int burst = 1 + static_cast<int>(rng() % 64);
+        for (int i = 0; i < burst; ++i) {
+          uint64_t* p = pool->allocate();
+          if (!p) break;
+          const uint64_t token = (uint64_t(t) << 48) | (uint64_t(round) << 16) | i;
+          *p = token;
+          held.emplace_back(p, token);
+        }
+        if (uint64_t* theirs = handoff[t].exchange(nullptr)) pool->deallocate(theirs);
+        while (held.size() > 8) {
+          auto [p, token] = held.back();
+          held.pop_back();
+          if (*p != token) ++bad;
+          if (held.size() % 2) {
+            *p = 0;
+            if (uint64_t* prev = handoff[(t + 1) % kThreads].exchange(p))
+              pool->deallocate(prev);
+          } else {
+            pool->deallocate(p);
+          }
+        }
+      }
+      for (auto [p, token] : held) {
+        if (*p != token) ++bad;
+        pool->deallocate(p);
+      }
+      pool->drain_local();
+    });
+  }
+  for (auto& th : threads) th.join();
+  for (auto& h : handoff)
+    if (uint64_t* p = h.exchange(nullptr)) pool->deallocate(p);
+  pool->drain_local();
+  ASSERT_EQ(bad.load(), 0);
+  ASSERT_EQ(pool->size_used(), 0u);
+  // Every block is back and can be handed out once.
+  std::vector<uint64_t*> all;
+  while (uint64_t* p = pool->allocate()) all.push_back(p);
+  ASSERT_EQ(all.size(), kCap);
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+}
+
 TEST(MemoryPool, OrderNodePool) {
   OrderNodePool pool(100);
   std::vector<OrderNodePool::Node*> nodes;
@@ -32,3 +127,57 @@ TEST(MemoryPool, OrderNodePool) {
     pool.deallocate(n);
   ASSERT_EQ(pool.size_used(), 0u);
 }
+
+TEST(MemoryPool, ChunkedPoolRecyclesAndGrowsWithoutMoving) {
+  ChunkedPool<int> pool(4, 2);
+  std::vector<int*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(pool.allocate());
+    *ptrs.back() = i;
+  }
+  ASSERT_EQ(pool.chunk_count(), 1u);
+  int* fifth = pool.allocate();
+  ASSERT_NE(fifth, nullptr);
+  ASSERT_EQ(pool.chunk_count(), 2u);
+  for (int i = 0; i < 4; ++i)
+    ASSERT_EQ(*ptrs[i], i);
+  pool.deallocate(fifth);
+  ASSERT_EQ(pool.allocate(), fifth);
+  for (int i = 0; i < 3; ++i)
+    ASSERT_NE(pool.allocate(), nullptr);
+  ASSERT_EQ(pool.allocate(), nullptr);
+  ASSERT_EQ(pool.size_used(), 8u);
+  ASSERT_EQ(pool.high_water(), 8u);
+}
+
+TEST(HugeArena, BumpAllocatesAlignedAndBacksContainers) {
+  HugeArena arena(1 << 20, {.huge_pages = true, .prefault = true, .numa_node = NUMA_LOCAL});
+  ASSERT_EQ(arena.capacity(), HUGE_PAGE_SIZE);
+  void* a = arena.allocate(10, 1);
+  void* b = arena.allocate(64, 64);
+  ASSERT_TRUE(arena.owns(a));
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(b) % 64, 0u);
+  ASSERT_EQ(arena.allocate(arena.capacity(), 1), nullptr);
+
+  // Containers draw from the arena and spill to the heap once it is full.
+  std::vector<int, ArenaAllocator<int>> v{ArenaAllocator<int>(&arena)};
+  v.reserve(1000);
+  ASSERT_TRUE(arena.owns(v.data()));
+  std::vector<int, ArenaAllocator<int>> big{ArenaAllocator<int>(&arena)};
+  big.resize(HUGE_PAGE_SIZE);
+  ASSERT_FALSE(arena.owns(big.data()));
+
+  auto ring = arena_shared<SPSCRingBuffer<int, 1024>>(arena);
+  ASSERT_TRUE(arena.owns(ring.get()));
+  ASSERT_TRUE(ring->try_push(7));
+}
+
+TEST(HugeArena, OrderBookOnArena) {
+  HugeArena arena(64 << 20);
+  OrderBook book(1 << 14, 1024, DEFAULT_DEPTH_LEVELS, 256, &arena);
+  ASSERT_GT(arena.used(), (1u << 14) * sizeof(OrderNodePool::Node));
+  for (OrderId id = 1; id <= 1000; ++id)
+    ASSERT_TRUE(book.add_order(id, 100 + static_cast<Price>(id % 50), 1, Side::Buy));
+  ASSERT_EQ(book.best_bid(), 149);
+  ASSERT_EQ(book.bid_volume(), 1000);
+}
@@ -1,5 +1,11 @@
 #include <gtest/gtest.h>
 #include "lumina/order_book.hpp"
+#include "lumina/mbp_book.hpp"
+#include "lumina/book_snapshot.hpp"
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <unordered_map>
 
 using namespace lumina;
 
@@ -24,3 +30,371 @@ TEST(OrderBook, MidAndVolume) {
   ASSERT_EQ(bv, 100);
   ASSERT_EQ(av, 100);
 }
+
+TEST(OrderBook, BestPriceAfterTouchCancels) {
+  OrderBook book(1024);
+  for (int i = 0; i < 50; ++i) {
+    book.add_order(i + 1, 1000 - i, 10, Side::Buy);
+    book.add_order(100 + i + 1, 1001 + i, 10, Side::Sell);
+  }
+  for (int i = 0; i < 49; ++i) {
+    book.cancel_order(i + 1);
+    book.cancel_order(100 + i + 1);
+    ASSERT_EQ(book.best_bid(), 1000 - i - 1);
+    ASSERT_EQ(book.best_ask(), 1001 + i + 1);
+  }
+  book.cancel_order(50);
+  book.cancel_order(150);
+  ASSERT_EQ(book.best_bid(), 0);
+  ASSERT_EQ(book.best_ask(), 0);
+}
+
+TEST(PriceLadder, WindowSlidesAndOverflowStaysSorted) {
+  PriceLadder ladder(Side::Buy, 64);
+  PriceLevel levels[4];
+  const Price prices[4] = {1000, 900, 1040, 10};
+  for (int i = 0; i < 4; ++i) {
+    levels[i].price = prices[i];
+    ladder.insert(prices[i], &levels[i]);
+  }
+  ASSERT_EQ(ladder.size(), 4u);
+  ASSERT_EQ(ladder.best(), &levels[2]);
+  ASSERT_EQ(ladder.find(900), &levels[1]);
+  ASSERT_GT(ladder.overflow_size(), 0u);
+  std::vector<Price> seen;
+  ladder.for_each([&](const PriceLevel* l) { seen.push_back(l->price); });
+  ASSERT_EQ(seen, (std::vector<Price>{1040, 1000, 900, 10}));
+  ladder.erase(1040);
+  ASSERT_EQ(ladder.best(), &levels[0]);
+  ladder.erase(1000);
+  ASSERT_EQ(ladder.best(), &levels[1]);
+  ASSERT_EQ(ladder.find(10), &levels[3]);
+  ladder.erase(900);
+  ASSERT_EQ(ladder.best(), &levels[3]);
+  ladder.erase(10);
+  ASSERT_TRUE(ladder.empty());
+  ASSERT_EQ(ladder.best(), nullptr);
+}
+
+TEST(OrderBook, IncrementalVolumesCountsAndDepth) {
+  OrderBook book(1024, 4096, 3);
+  book.add_order(1, 100, 10, Side::Buy);
+  book.add_order(2, 100, 5, Side::Buy);
+  book.add_order(3, 99, 7, Side::Buy);
+  book.add_order(4, 98, 1, Side::Buy);
+  book.add_order(5, 97, 2, Side::Buy);
+  ASSERT_EQ(book.best_bid_level().count, 2);
+  ASSERT_EQ(book.bid_volume(), 25);
+  ASSERT_EQ(book.depth_qty(Side::Buy), 23);
+  book.add_order(6, 101, 4, Side::Buy);  // pushes 98 out of the top 3
+  ASSERT_EQ(book.depth_qty(Side::Buy), 26);
+  book.cancel_order(6);                  // 98 comes back in
+  ASSERT_EQ(book.depth_qty(Side::Buy), 23);
+  book.cancel_order(3);                  // 97 joins
+  ASSERT_EQ(book.depth_qty(Side::Buy), 18);
+  FillSink fills;
+  book.match(Side::Sell, 12, fills);
+  ASSERT_EQ(book.bid_volume(), 6);
+  ASSERT_EQ(book.best_bid_level().count, 1);
+  ASSERT_EQ(book.depth_qty(Side::Buy), 6);
+  ASSERT_EQ(book.depth_qty(Side::Sell), 0);
+}
+
+TEST(OrderBook, DriftingPriceReusesLevels) {
+  OrderBook book(1024, 4096, 10, 16);
+  for (OrderId id = 1; id <= 100000; ++id) {
+    ASSERT_TRUE(book.add_order(id, 1000 + static_cast<Price>(id), 10, Side::Buy));
+    if (id > 8) book.cancel_order(id - 8);
+  }
+  ASSERT_EQ(book.level_pool().size_used(), 8u);
+  ASSERT_EQ(book.level_pool().chunk_count(), 1u);
+  ASSERT_EQ(book.best_bid(), 101000);
+}
+
+TEST(OrderIdMap, MatchesUnorderedMapUnderChurn) {
+  OrderIdMap<int*> index(512);
+  std::unordered_map<OrderId, int*> ref;
+  int values[1024];
+  std::mt19937_64 gen(42);
+  for (int step = 0; step < 100000; ++step) {
+    OrderId id = gen() % 1024;
+    if (gen() % 2) {
+      bool inserted = index.insert(id, &values[id]);
+      bool expected = ref.size() < 512 && ref.emplace(id, &values[id]).second;
+      ASSERT_EQ(inserted, expected);
+    } else {
+      auto it = ref.find(id);
+      ASSERT_EQ(index.erase(id), it == ref.end() ? nullptr : it->second);
+      if (it != ref.end()) ref.erase(it);
+    }
+    ASSERT_EQ(index.size(), ref.size());
+  }
+  for (OrderId id = 0; id < 1024; ++id)
+    ASSERT_EQ(index.find(id), ref.count(id) ? ref[id] : nullptr);
+}
+
+TEST(OrderBook, DuplicateIdRejected) {
+  OrderBook book(16);
+  ASSERT_TRUE(book.add_order(7, 100, 10, Side::Buy));
+  ASSERT_FALSE(book.add_order(7, 101, 10, Side::Buy));
+  ASSERT_EQ(book.best_bid(), 100);
+  ASSERT_EQ(book.order_pool().size_used(), 1u);
+}
+
+TEST(OrderBook, CrossingLimitTradesBeforeResting) {
+  OrderBook book(1024);
+  FillSink fills;
+  book.add_order(1, 100, 5, Side::Sell);
+  book.add_order(2, 101, 5, Side::Sell);
+  book.add_order(3, 100, 5, Side::Sell);
+  ExecReport r = book.submit_order(10, 101, 12, Side::Buy, TimeInForce::GTC, false, 777, fills);
+  ASSERT_EQ(r.status, ExecStatus::Filled);
+  ASSERT_EQ(fills.size(), 3u);
+  ASSERT_EQ(fills[0].ask_id, 1u);  // time priority at 100
+  ASSERT_EQ(fills[1].ask_id, 3u);
+  ASSERT_EQ(fills[2].ask_id, 2u);
+  ASSERT_EQ(fills[2].qty, 2);
+  for (const Trade& t : fills) {
+    ASSERT_EQ(t.bid_id, 10u);
+    ASSERT_EQ(t.time_ns, 777);
+  }
+  fills.clear();
+  r = book.submit_order(11, 102, 10, Side::Buy, TimeInForce::GTC, false, 778, fills);
+  ASSERT_EQ(r.status, ExecStatus::PartiallyFilled);
+  ASSERT_EQ(r.filled_qty, 3);
+  ASSERT_EQ(r.leaves_qty, 7);
+  ASSERT_EQ(book.best_bid(), 102);
+  ASSERT_EQ(book.best_ask(), 0);
+}
+
+TEST(OrderBook, IocFokAndPostOnly) {
+  OrderBook book(1024);
+  FillSink fills;
+  book.add_order(1, 100, 5, Side::Buy);
+  book.add_order(2, 99, 5, Side::Buy);
+  ExecReport r = book.submit_order(10, 99, 20, Side::Sell, TimeInForce::FOK, false, 0, fills);
+  ASSERT_EQ(r.status, ExecStatus::Rejected);
+  ASSERT_TRUE(fills.empty());
+  ASSERT_EQ(book.bid_volume(), 10);
+  r = book.submit_order(11, 100, 3, Side::Sell, TimeInForce::GTC, true, 0, fills);
+  ASSERT_EQ(r.status, ExecStatus::Rejected);
+  r = book.submit_order(12, 101, 3, Side::Sell, TimeInForce::GTC, true, 0, fills);
+  ASSERT_EQ(r.status, ExecStatus::Rested);
+  r = book.submit_order(13, 100, 8, Side::Sell, TimeInForce::IOC, false, 0, fills);
+  ASSERT_EQ(r.status, ExecStatus::Cancelled);
+  ASSERT_EQ(r.filled_qty, 5);
+  ASSERT_EQ(book.best_bid(), 99);
+  ASSERT_EQ(book.best_ask(), 101);
+  r = book.submit_order(14, 99, 5, Side::Sell, TimeInForce::FOK, false, 0, fills);
+  ASSERT_EQ(r.status, ExecStatus::Filled);
+  ASSERT_EQ(book.bid_volume(), 0);
+}
+
+TEST(OrderBook, ModifyReduceKeepsPriority) {
+  OrderBook book(1024);
+  FillSink fills;
+  book.add_order(1, 100, 10, Side::Buy);
+  book.add_order(2, 100, 10, Side::Buy);
+  ASSERT_EQ(book.modify_order(1, 100, 4, 0, fills).status, ExecStatus::Rested);
+  ASSERT_EQ(book.bid_volume(), 14);
+  book.match(Side::Sell, 4, fills);
+  ASSERT_EQ(fills.back().bid_id, 1u);
+  fills.clear();
+  book.add_order(3, 100, 10, Side::Buy);
+  book.modify_order(2, 100, 20, 0, fills);  // size up: back of the queue
+  book.match(Side::Sell, 1, fills);
+  ASSERT_EQ(fills.back().bid_id, 3u);
+  ExecReport r = book.modify_order(2, 101, 20, 0, fills);
+  ASSERT_EQ(r.status, ExecStatus::Rested);
+  ASSERT_EQ(book.best_bid(), 101);
+}
+
+TEST(OrderBook, ModifyKeepsPostOnly) {
+  OrderBook book(64);
+  FillSink fills;
+  book.add_order(10, 102, 5, Side::Sell);
+  ASSERT_EQ(book.submit_order(1, 100, 10, Side::Buy, TimeInForce::GTC, true, 0, fills).status,
+            ExecStatus::Rested);
+  ExecReport r = book.modify_order(1, 102, 10, 0, fills);  // would take
+  ASSERT_EQ(r.status, ExecStatus::Rejected);
+  ASSERT_EQ(r.leaves_qty, 10);
+  ASSERT_TRUE(fills.empty());
+  ASSERT_EQ(book.best_bid(), 100);
+  ASSERT_EQ(book.ask_volume(), 5);
+  ASSERT_EQ(book.modify_order(1, 101, 12, 0, fills).status, ExecStatus::Rested);
+  ASSERT_TRUE(book.find_order(1)->post_only);
+
+  // The flag survives a checkpoint.
+  std::stringstream buf;
+  ASSERT_TRUE(book.save_snapshot(buf, 1));
+  OrderBook restored(64);
+  uint64_t seq = 0;
+  ASSERT_TRUE(restored.load_snapshot(buf, seq));
+  ASSERT_EQ(restored.modify_order(1, 103, 12, 0, fills).status, ExecStatus::Rejected);
+  ASSERT_EQ(restored.best_bid(), 101);
+
+  // A plain order modified through the ask still trades.
+  book.add_order(2, 99, 3, Side::Buy);
+  r = book.modify_order(2, 102, 3, 0, fills);
+  ASSERT_EQ(r.status, ExecStatus::Filled);
+  ASSERT_EQ(fills.size(), 1u);
+}
+
+TEST(OrderBook, SnapshotDepthSorted) {
+  OrderBook book(1024, 64);
+  const Price bids[] = {100, 97, 99, 50, 98};  // 50 lands in the overflow
+  for (int i = 0; i < 5; ++i)
+    book.add_order(i + 1, bids[i], 10 + i, Side::Buy);
+  book.add_order(10, 101, 1, Side::Sell);
+  book.add_order(11, 103, 2, Side::Sell);
+  book.add_order(12, 103, 3, Side::Sell);
+  book.cancel_order(3);  // drop 99
+  DepthSnapshot<8> snap;
+  book.snapshot_depth(3, snap);
+  ASSERT_EQ(snap.bid_levels, 3u);
+  ASSERT_EQ(snap.bid_price[0], 100);
+  ASSERT_EQ(snap.bid_price[1], 98);
+  ASSERT_EQ(snap.bid_price[2], 97);
+  ASSERT_EQ(snap.bid_qty[1], 14);
+  ASSERT_EQ(snap.ask_levels, 2u);
+  ASSERT_EQ(snap.ask_price[1], 103);
+  ASSERT_EQ(snap.ask_qty[1], 5);
+  ASSERT_EQ(snap.ask_count[1], 2);
+  book.snapshot_depth(100, snap);
+  ASSERT_EQ(snap.bid_levels, 4u);
+  ASSERT_EQ(snap.bid_price[3], 50);
+}
+
+TEST(MbpBook, SetDeleteAndDeltaLevels) {
+  MbpBook book(4096, 2);
+  book.set_level(Side::Buy, 100, 50, 3);
+  book.set_level(Side::Buy, 99, 20, 1);
+  book.set_level(Side::Buy, 98, 10, 1);
+  book.set_level(Side::Sell, 101, 30, 2);
+  ASSERT_EQ(book.best_bid(), 100);
+  ASSERT_EQ(book.best_ask(), 101);
+  ASSERT_EQ(book.mid_price(), 100);
+  ASSERT_EQ(book.bid_volume(), 80);
+  ASSERT_EQ(book.depth_qty(Side::Buy), 70);
+  ASSERT_EQ(book.best_bid_level().count, 3);
+  book.set_level(Side::Buy, 100, 40, 2);
+  ASSERT_EQ(book.bid_volume(), 70);
+  book.apply_delta(Side::Buy, 100, -40, -2);
+  ASSERT_EQ(book.best_bid(), 99);
+  ASSERT_EQ(book.depth_qty(Side::Buy), 30);
+  book.delete_level(Side::Buy, 99);
+  ASSERT_EQ(book.bid_volume(), 10);
+  DepthSnapshot<4> snap;
+  book.snapshot_depth(4, snap);
+  ASSERT_EQ(snap.bid_levels, 1u);
+  ASSERT_EQ(snap.ask_qty[0], 30);
+  book.clear();
+  ASSERT_EQ(book.best_ask(), 0);
+  ASSERT_EQ(book.level_pool().size_used(), 0u);
+}
+
+TEST(OrderBook, SnapshotRoundTrip) {
+  OrderBook book(1024, 64);
+  book.add_order(1, 100, 10, Side::Buy, 11);
+  book.add_order(2, 100, 20, Side::Buy, 12);
+  book.add_order(3, 98, 5, Side::Buy, 13);
+  book.add_order(4, 10, 7, Side::Buy, 14);  // overflow level
+  book.add_order(5, 101, 3, Side::Sell, 15);
+  book.add_order(6, 105, 4, Side::Sell, 16);
+  std::stringstream buf;
+  ASSERT_TRUE(book.save_snapshot(buf, 4242));
+
+  OrderBook restored(1024, 64);
+  restored.add_order(99, 50, 1, Side::Sell);  // replaced by the load
+  uint64_t seq = 0;
+  ASSERT_TRUE(restored.load_snapshot(buf, seq));
+  ASSERT_EQ(seq, 4242u);
+  ASSERT_EQ(restored.best_bid(), 100);
+  ASSERT_EQ(restored.best_ask(), 101);
+  ASSERT_EQ(restored.bid_volume(), 42);
+  ASSERT_EQ(restored.ask_volume(), 7);
+  ASSERT_EQ(restored.best_bid_level().count, 2);
+  ASSERT_EQ(restored.depth_qty(Side::Buy), book.depth_qty(Side::Buy));
+  ASSERT_EQ(restored.order_pool().size_used(), 6u);
+  FillSink fills;
+  restored.match(Side::Sell, 15, fills);
+  ASSERT_EQ(fills[0].bid_id, 1u);  // FIFO preserved
+  ASSERT_EQ(fills[1].bid_id, 2u);
+  restored.cancel_order(4);
+  ASSERT_EQ(restored.bid_volume(), 20);
+}
+
+TEST(OrderBook, SnapshotRejectsBadVersion) {
+  OrderBook book(16);
+  book.add_order(1, 100, 10, Side::Buy);
+  std::stringstream buf;
+  book.save_snapshot(buf, 1);
+  std::string bytes = buf.str();
+  bytes[4] = 99;  // version field
+  std::stringstream bad(bytes);
+  uint64_t seq = 0;
+  ASSERT_FALSE(book.load_snapshot(bad, seq));
+  ASSERT_EQ(book.best_bid(), 0);
+}
+
+TEST(OrderBook, SnapshotRejectsCountMismatchAndCrossedBook) {
+  OrderBook book(64);
+  book.add_order(1, 100, 10, Side::Buy);
+  book.add_order(2, 99, 10, Side::Buy);
+  book.add_order(3, 101, 5, Side::Sell);
+  std::stringstream buf;
+  ASSERT_TRUE(book.save_snapshot(buf, 7));
+  const std::string bytes = buf.str();
+  OrderBook restored(64);
+  uint64_t seq = 0;
+
+  // Header claims one order more than the levels hold.
+  std::string extra = bytes;
+  SnapshotHeader h;
+  std::memcpy(&h, extra.data(), sizeof(h));
+  ++h.order_count;
+  std::memcpy(extra.data(), &h, sizeof(h));
+  std::stringstream in_extra(extra);
+  ASSERT_FALSE(restored.load_snapshot(in_extra, seq));
+  ASSERT_EQ(restored.best_bid(), 0);
+
+  // Cut after the bids with the ask level count dropped to match: every
+  // record parses, but an order is missing.
+  std::string cut =
+      bytes.substr(0, bytes.size() - sizeof(SnapshotLevel) - sizeof(SnapshotOrder));
+  std::memcpy(&h, cut.data(), sizeof(h));
+  h.ask_levels = 0;
+  std::memcpy(cut.data(), &h, sizeof(h));
+  std::stringstream in_cut(cut);
+  ASSERT_FALSE(restored.load_snapshot(in_cut, seq));
+  ASSERT_EQ(restored.best_bid(), 0);
+
+  // A crossed book is not a valid checkpoint.
+  OrderBook crossed(64);
+  crossed.add_order(1, 102, 10, Side::Buy);
+  crossed.add_order(2, 101, 5, Side::Sell);
+  std::stringstream crossed_buf;
+  ASSERT_TRUE(crossed.save_snapshot(crossed_buf, 8));
+  ASSERT_FALSE(restored.load_snapshot(crossed_buf, seq));
+  ASSERT_EQ(restored.order_pool().size_used(), 0u);
+
+  std::stringstream in(bytes);
+  ASSERT_TRUE(restored.load_snapshot(in, seq));
+  ASSERT_EQ(seq, 7u);
+}
+
+TEST(OrderBook, LevelDeltasCoexistWithOrders) {
+  OrderBook book;
+  ASSERT_TRUE(book.add_order(1, 100, 5, Side::Buy));
+  ASSERT_EQ(book.apply_delta(Side::Buy, 100, 10), 10);
+  ASSERT_EQ(book.apply_delta(Side::Buy, 100, 4), 4);
+  EXPECT_EQ(book.level_qty(Side::Buy, 100), 19);
+  EXPECT_EQ(book.best_bid_level().count, 2);
+  ASSERT_EQ(book.apply_delta(Side::Buy, 100, -20), -14);  // only the feed qty goes
+  EXPECT_EQ(book.level_qty(Side::Buy, 100), 5);
+  EXPECT_EQ(book.find_order(OrderBook::level_order_id(Side::Buy, 100)), nullptr);
+  FillSink fills;
+  book.submit_order(2, 100, 5, Side::Sell, TimeInForce::IOC, false, 0, fills);
+  EXPECT_EQ(book.level_qty(Side::Buy, 100), 0);
+  EXPECT_EQ(book.best_bid(), 0);
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "lumina/quote_manager.hpp"
+#include "lumina/strategy_engine.hpp"
+#include <vector>
+
+using namespace lumina;
+
+namespace {
+struct Sent {
+  char kind;  // 'N'ew, 'R'eplace, 'C'ancel
+  OrderId id;
+  OrderId orig_id;
+  Price price;
+  Qty qty;
+};
+
+/// Records everything the manager sends.
+struct Recorder {
+  explicit Recorder(QuoteManager& qm, bool with_replace = true) {
+    qm.set_order_callback([this](OrderId id, Price px, Qty qty, Side, bool) {
+      sent.push_back({'N', id, 0, px, qty});
+    });
+    if (with_replace) {
+      qm.set_replace_callback([this](OrderId orig, OrderId id, Price px, Qty qty, Side, bool) {
+        sent.push_back({'R', id, orig, px, qty});
+      });
+    }
+    qm.set_cancel_callback([this](OrderId id) { sent.push_back({'C', id, 0, 0, 0}); });
+  }
+  std::vector<Sent> sent;
+};
+} // namespace
+
+TEST(QuoteManager, SendsOnlyRoundedChanges) {
+  QuoteManager qm;
+  Recorder rec(qm);
+  qm.update(Side::Buy, qm.round_to_tick(100.2), 10, 0);
+  qm.update(Side::Buy, qm.round_to_tick(99.8), 10, 1);  // still 100
+  qm.update(Side::Buy, qm.round_to_tick(101.4), 10, 2);
+  qm.update(Side::Buy, 101, 12, 3);  // size change
+  qm.update(Side::Buy, 101, 0, 4);   // pull
+  ASSERT_EQ(rec.sent.size(), 4u);
+  EXPECT_EQ(rec.sent[0].kind, 'N');
+  EXPECT_EQ(rec.sent[0].id, 1u);
+  EXPECT_EQ(rec.sent[0].price, 100);
+  EXPECT_EQ(rec.sent[1].kind, 'R');
+  EXPECT_EQ(rec.sent[1].orig_id, 1u);
+  EXPECT_EQ(rec.sent[1].id, 2u);
+  EXPECT_EQ(rec.sent[1].price, 101);
+  EXPECT_EQ(rec.sent[2].kind, 'R');
+  EXPECT_EQ(rec.sent[2].qty, 12);
+  EXPECT_EQ(rec.sent[3].kind, 'C');
+  EXPECT_EQ(rec.sent[3].id, 3u);
+  EXPECT_EQ(qm.bid().id, 0u);
+  EXPECT_EQ(qm.stats().held, 1u);
+
+  // No replace callback: a requote goes out as cancel + new.
+  QuoteManager plain;
+  Recorder rec2(plain, false);
+  plain.update(Side::Sell, 105, 10, 0);
+  plain.update(Side::Sell, 106, 10, 1);
+  ASSERT_EQ(rec2.sent.size(), 3u);
+  EXPECT_EQ(rec2.sent[1].kind, 'C');
+  EXPECT_EQ(rec2.sent[1].id, 1u);
+  EXPECT_EQ(rec2.sent[2].kind, 'N');
+  EXPECT_EQ(plain.ask().id, 2u);
+  EXPECT_EQ(plain.ask().price, 106);
+}
+
+TEST(QuoteManager, HoldsMovesUnderRequoteThreshold) {
+  QuoteManagerOptions options;
+  options.tick_size = 5;
+  options.min_requote_ticks = 2;
+  QuoteManager qm(options);
+  Recorder rec(qm);
+  qm.update(Side::Buy, 1000, 10, 0);
+  EXPECT_EQ(qm.round_to_tick(1003.0), 1005);
+  qm.update(Side::Buy, 1005, 10, 1);  // one tick away
+  EXPECT_EQ(qm.bid().price, 1000);
+  qm.update(Side::Buy, qm.round_to_tick(1011.0), 10, 2);  // 1010: two ticks
+  EXPECT_EQ(qm.bid().price, 1010);
+  EXPECT_EQ(rec.sent.size(), 2u);
+  EXPECT_EQ(qm.stats().held, 1u);
+  EXPECT_EQ(qm.stats().replaces, 1u);
+}
+
+TEST(QuoteManager, ThrottlesToMessageBudget) {
+  QuoteManagerOptions options;
+  options.max_msgs_per_sec = 10;
+  QuoteManager qm(options);
+  Recorder rec(qm);
+  for (int i = 0; i < 20; ++i) qm.update(Side::Buy, 100 + i, 10, 0);
+  EXPECT_EQ(rec.sent.size(), 10u);
+  EXPECT_EQ(qm.stats().throttled, 10u);
+  EXPECT_EQ(qm.bid().price, 109);  // last admitted
+
+  qm.update(Side::Sell, 200, 10, 50'000'000);  // half an interval later
+  EXPECT_EQ(qm.ask().id, 0u);
+  qm.update(Side::Sell, 200, 10, 100'000'000);
+  EXPECT_NE(qm.ask().id, 0u);
+
+  // Pulling a quote is never held back.
+  qm.update(Side::Buy, 0, 0, 100'000'000);
+  EXPECT_EQ(qm.bid().id, 0u);
+  EXPECT_EQ(rec.sent.back().kind, 'C');
+}
+
+TEST(QuoteManager, FillsFreeTheSide) {
+  QuoteManager qm;
+  Recorder rec(qm);
+  qm.update(Side::Buy, 100, 10, 0);
+  const OrderId id = qm.bid().id;
+  qm.on_fill(id, 4);
+  EXPECT_EQ(qm.bid().qty, 6);
+  qm.update(Side::Buy, 100, 10, 1);  // topped back up
+  EXPECT_EQ(rec.sent.back().kind, 'R');
+  qm.on_fill(qm.bid().id, 10);
+  EXPECT_EQ(qm.bid().id, 0u);
+  qm.update(Side::Buy, 100, 10, 2);
+  EXPECT_EQ(rec.sent.back().kind, 'N');
+  qm.on_order_closed(qm.bid().id);
+  EXPECT_EQ(qm.bid().id, 0u);
+}
+
+TEST(QuoteManager, StrategyRequotesOnlyWhenQuoteMoves) {
+  auto ring = std::make_shared<StrategyEngine::MDRing>();
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine engine(ring, 0.1, 0.02, 1.0, risk);
+  size_t news = 0, cancels = 0;
+  engine.set_order_callback([&](OrderId id, Price, Qty qty, Side, bool) {
+    EXPECT_NE(id, 0u);
+    EXPECT_EQ(qty, 100);
+    ++news;
+  });
+  engine.set_cancel_callback([&](OrderId) { ++cancels; });
+  MarketDataEvent ev{};
+  ev.flag = MDFlag::BookUpdate;
+  ev.bid = 9999;
+  ev.ask = 10001;
+  for (int i = 0; i < 50; ++i) {
+    ev.ts_ns = i;
+    ASSERT_TRUE(ring->try_push(ev));
+  }
+  engine.poll();
+  EXPECT_EQ(news, 2u);
+  EXPECT_EQ(cancels, 0u);
+  EXPECT_EQ(engine.quotes().stats().held, 98u);
+
+  risk.kill();
+  ASSERT_TRUE(ring->try_push(ev));
+  engine.poll();
+  EXPECT_EQ(cancels, 2u);
+}
+
+TEST(QuoteManager, StrategyRiskChecksThePriceItSends) {
+  auto ring = std::make_shared<StrategyEngine::MDRing>();
+  // Room for 100 lots at 10000 but not at 10002.
+  PreTradeRisk risk(1'000'100, 1000);
+  StrategyEngine engine(ring, 0.1, 0.02, 1.0, risk);
+  QuoteManagerOptions options;
+  options.tick_size = 5;
+  engine.set_quote_options(options);
+  std::vector<Price> prices;
+  engine.set_order_callback([&](OrderId, Price px, Qty, Side, bool) { prices.push_back(px); });
+  MarketDataEvent ev{};
+  ev.flag = MDFlag::BookUpdate;
+  ev.bid = 10001;
+  ev.ask = 10003;  // quotes within a tick of 10002: sent at 10000
+  ASSERT_TRUE(ring->try_push(ev));
+  engine.poll();
+  ASSERT_EQ(prices.size(), 2u);
+  EXPECT_EQ(prices[0], 10000);
+  EXPECT_EQ(prices[1], 10000);
+}
@@ -1,6 +1,13 @@
 #include <gtest/gtest.h>
 #include "lumina/ring_buffer.hpp"
+#include "lumina/multicast_ring.hpp"
 #include "lumina/types.hpp"
+#include "lumina/wait_strategy.hpp"
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
 
 using namespace lumina;
 
@@ -18,12 +25,231 @@ TEST(RingBuffer, SPSCPushPop) {
   ASSERT_FALSE(rb.try_pop(x));
 }
 
+TEST(RingBuffer, SPSCBatchWrapsAround) {
+  SPSCRingBuffer<int, 16> rb;
+  int in[20], out[20];
+  std::iota(in, in + 20, 0);
+  ASSERT_EQ(rb.try_push_n(in, 10), 10u);
+  ASSERT_EQ(rb.try_pop_n(out, 10), 10u);
+  ASSERT_EQ(rb.try_push_n(in, 20), 16u);  // wraps, truncated to capacity
+  ASSERT_EQ(rb.try_push_n(in, 1), 0u);
+  ASSERT_EQ(rb.try_pop_n(out, 20), 16u);
+  for (int i = 0; i < 16; ++i) ASSERT_EQ(out[i], i);
+  ASSERT_EQ(rb.try_pop_n(out, 1), 0u);
+}
+
+TEST(RingBuffer, SPSCClaimCommitPeekRelease) {
+  SPSCRingBuffer<MarketDataEvent, 4> rb;
+  for (int i = 0; i < 4; ++i) {
+    MarketDataEvent* slot = rb.claim();
+    ASSERT_NE(slot, nullptr);
+    slot->bid = 100 + i;
+    rb.commit();
+  }
+  ASSERT_EQ(rb.claim(), nullptr);
+  for (int i = 0; i < 4; ++i) {
+    const MarketDataEvent* slot = rb.peek();
+    ASSERT_NE(slot, nullptr);
+    ASSERT_EQ(slot->bid, 100 + i);
+    rb.release();
+  }
+  ASSERT_EQ(rb.peek(), nullptr);
+  ASSERT_NE(rb.claim(), nullptr);
+}
+
+TEST(RingBuffer, SPSCHasRoomSeesConsumerProgress) {
+  auto rb = std::make_unique<SPSCRingBuffer<int, 8>>();
+  ASSERT_TRUE(rb->has_room(8));
+  ASSERT_FALSE(rb->has_room(9));
+  for (int i = 0; i < 3; ++i) ASSERT_TRUE(rb->try_push(i));
+  ASSERT_TRUE(rb->has_room(5));
+  ASSERT_FALSE(rb->has_room(6));
+  int v = 0;
+  ASSERT_TRUE(rb->try_pop(v));
+  ASSERT_TRUE(rb->has_room(6));
+  ASSERT_TRUE(rb->has_room(0));
+}
+
+TEST(RingBuffer, SPSCCrossThreadBatchesKeepOrder) {
+  auto rb = std::make_unique<SPSCRingBuffer<uint64_t, 1024>>();
+  constexpr uint64_t kItems = 1 << 20;
+  std::thread producer([&] {
+    uint64_t buf[37];
+    for (uint64_t next = 0; next < kItems;) {
+      const size_t n = std::min<uint64_t>(37, kItems - next);
+      for (size_t i = 0; i < n; ++i) buf[i] = next + i;
+      next += rb->try_push_n(buf, n);
+    }
+  });
+  uint64_t expected = 0, buf[64];
+  while (expected < kItems) {
+    const size_t n = rb->try_pop_n(buf, 64);
+    for (size_t i = 0; i < n; ++i) ASSERT_EQ(buf[i], expected++);
+  }
+  producer.join();
+  ASSERT_TRUE(rb->empty());
+}
+
 TEST(RingBuffer, MPMCPushPop) {
   MPMCRingBuffer<MarketDataEvent, 16> rb;
   MarketDataEvent e{};
-  e.mid = 100;
+  e.bid = 100;
   ASSERT_TRUE(rb.try_push(e));
   MarketDataEvent out;
   ASSERT_TRUE(rb.try_pop(out));
-  ASSERT_EQ(out.mid, 100);
+  ASSERT_EQ(out.bid, 100);
+}
+
+namespace {
+// P producers push disjoint ranges through a small queue (so it is full and
+// empty often); C consumers pop with the blocking call. Every value must
+// come out exactly once, and each consumer sees each producer's values in
+// order.
+template <typename Wait>
+void mpmc_stress(int producers, int consumers) {
+  constexpr uint64_t kPerProducer = 20000;
+  auto q = std::make_unique<MPMCRingBuffer<uint64_t, 64, Wait>>();
+  const uint64_t total = kPerProducer * producers;
+  std::vector<std::vector<uint64_t>> seen(consumers);
+  std::atomic<uint64_t> popped{0};
+  std::vector<std::thread> threads;
+  for (int c = 0; c < consumers; ++c) {
+    threads.emplace_back([&, c] {
+      std::vector<uint64_t> last(producers, 0);
+      while (popped.fetch_add(1) < total) {
+        uint64_t v;
+        q->pop(v);
+        const uint64_t p = v / kPerProducer;
+        ASSERT_GE(v % kPerProducer + 1, last[p]);
+        last[p] = v % kPerProducer + 1;
+        seen[c].push_back(v);
+      }
+    });
+  }
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (uint64_t i = 0; i < kPerProducer; ++i) q->push(p * kPerProducer + i);
+    });
+  }
+  for (auto& t : threads) t.join();
+  std::vector<uint64_t> all;
+  for (auto& s : seen) all.insert(all.end(), s.begin(), s.end());
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(all.size(), total);
+  for (uint64_t i = 0; i < total; ++i) ASSERT_EQ(all[i], i);
+  uint64_t v;
+  ASSERT_FALSE(q->try_pop(v));
+}
+} // namespace
+
+TEST(RingBuffer, MPMCFullAndEmpty) {
+  MPMCRingBuffer<int, 4> q;
+  for (int i = 0; i < 4; ++i) ASSERT_TRUE(q.try_push(i));
+  ASSERT_FALSE(q.try_push(4));
+  ASSERT_FALSE(q.try_push(4));  // repeated failures must not consume positions
+  int x;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(q.try_pop(x));
+    ASSERT_EQ(x, i);
+  }
+  ASSERT_FALSE(q.try_pop(x));
+  ASSERT_TRUE(q.try_push(5));
+  ASSERT_TRUE(q.try_pop(x));
+  ASSERT_EQ(x, 5);
+}
+
+TEST(RingBuffer, MPMCStressSpinYield) { mpmc_stress<SpinYieldWait>(4, 4); }
+TEST(RingBuffer, MPMCStressFutex) { mpmc_stress<FutexWait>(3, 5); }
+
+TEST(IdleStrategy, ForeverPhasesOutlastLongQuiet) {
+  using Phase = IdleStrategy::Phase;
+  auto phase_at = [](const IdleStrategy& s, uint64_t n) { return s.phase(n); };
+  const uint64_t quiet = (uint64_t{1} << 40) + 7;  // far past any 32-bit count
+  EXPECT_EQ(phase_at(IdleStrategy::busy_spin(), quiet), Phase::Spin);
+  EXPECT_EQ(phase_at(IdleStrategy::busy_spin(), UINT64_MAX), Phase::Spin);
+  EXPECT_EQ(phase_at(IdleStrategy::pause_spin(), quiet), Phase::Pause);
+  EXPECT_EQ(phase_at(IdleStrategy::pause_spin(), UINT64_MAX), Phase::Pause);
+  EXPECT_EQ(phase_at(IdleStrategy::spin_yield(), 10), Phase::Pause);
+  EXPECT_EQ(phase_at(IdleStrategy::spin_yield(), quiet), Phase::Yield);
+  IdleStrategy::busy_spin().idle(quiet);
+
+  const IdleStrategy backoff{};
+  EXPECT_EQ(phase_at(backoff, 0), Phase::Pause);
+  EXPECT_EQ(phase_at(backoff, 1024), Phase::Yield);
+  EXPECT_EQ(phase_at(backoff, 1024 + 64), Phase::Sleep);
+  EXPECT_EQ(phase_at(backoff, quiet), Phase::Sleep);
+}
+
+TEST(MulticastRing, RepeatedDepsCountOnce) {
+  MulticastRing<int, 4, 4> ring;
+  const int first = ring.add_consumer();
+  ASSERT_EQ(ring.add_consumer({first, first, first, first, first, first}), 1);
+  ASSERT_EQ(ring.add_consumer({0, 1, 0, 1, 1}), 2);
+  ASSERT_TRUE(ring.try_publish(1));
+  ASSERT_EQ(ring.available(1), 0u);
+  ASSERT_EQ(ring.poll(first, [](int) {}), 1u);
+  ASSERT_EQ(ring.available(1), 1u);
+  ASSERT_EQ(ring.available(2), 0u);
+}
+
+TEST(MulticastRing, DependentConsumerTrailsAndProducerIsGated) {
+  MulticastRing<int, 4> ring;
+  const int strategy = ring.add_consumer();
+  const int risk = ring.add_consumer();
+  const int recorder = ring.add_consumer({strategy});
+  ASSERT_EQ(ring.add_consumer({7}), -1);
+  for (int i = 0; i < 4; ++i) ASSERT_TRUE(ring.try_publish(i));
+  ASSERT_FALSE(ring.try_publish(4));  // nobody has read yet
+  ASSERT_EQ(ring.available(risk), 4u);
+  ASSERT_EQ(ring.available(recorder), 0u);  // strategy has not passed anything
+
+  std::vector<int> got;
+  ASSERT_EQ(ring.poll(strategy, [&](int v) { got.push_back(v); }, 2), 2u);
+  ASSERT_EQ(ring.available(recorder), 2u);
+  ASSERT_EQ(ring.at(recorder, 1), 1);
+  ring.release(recorder, 2);
+  ASSERT_FALSE(ring.try_publish(4));  // risk still holds the oldest slot
+  ASSERT_EQ(ring.poll(risk, [](int) {}), 4u);
+  ASSERT_TRUE(ring.try_publish(4));
+  ASSERT_TRUE(ring.try_publish(5));
+  ASSERT_FALSE(ring.try_publish(6));  // gated by strategy and recorder at 2
+  // The cached limit is only refreshed once it has been consumed.
+  ASSERT_EQ(ring.poll(strategy, [&](int v) { got.push_back(v); }), 2u);
+  ASSERT_EQ(ring.poll(strategy, [&](int v) { got.push_back(v); }), 2u);
+  ASSERT_EQ(got, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+}
+
+TEST(MulticastRing, CrossThreadConsumersSeeEveryEventInOrder) {
+  using Ring = MulticastRing<uint64_t, 256>;
+  auto ring = std::make_unique<Ring>();
+  constexpr uint64_t kEvents = 200000;
+  const int strategy = ring->add_consumer();
+  const int risk = ring->add_consumer();
+  const int recorder = ring->add_consumer({strategy, risk});
+  std::vector<std::thread> threads;
+  std::atomic<bool> ok{true};
+  for (int id : {strategy, risk, recorder}) {
+    threads.emplace_back([&, id] {
+      uint64_t expected = 0;
+      while (expected < kEvents) {
+        const size_t n = ring->poll(id, [&](uint64_t v) {
+          if (v != expected++) ok = false;
+          if (id == recorder && (ring->cursor(strategy) <= v || ring->cursor(risk) <= v))
+            ok = false;
+        });
+        if (n == 0) std::this_thread::yield();
+      }
+    });
+  }
+  uint64_t batch[16];
+  for (uint64_t next = 0; next < kEvents;) {
+    const size_t n = std::min<uint64_t>(16, kEvents - next);
+    for (size_t i = 0; i < n; ++i) batch[i] = next + i;
+    const size_t pushed = ring->try_publish_n(batch, n);
+    if (pushed == 0) std::this_thread::yield();
+    next += pushed;
+  }
+  for (auto& t : threads) t.join();
+  ASSERT_TRUE(ok);
+  ASSERT_EQ(ring->cursor(recorder), kEvents);
 }
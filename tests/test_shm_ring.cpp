@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include "lumina/shm_ring.hpp"
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace lumina;
+
+namespace {
+std::string ring_name(const char* tag) {
+  return "/lumina_test_" + std::string(tag) + "_" + std::to_string(getpid());
+}
+
+MarketDataEvent event(int64_t i) {
+  MarketDataEvent ev{};
+  ev.flag = MDFlag::BestBidAsk;
+  ev.ts_ns = i;
+  ev.bid = 1000 + i;
+  return ev;
+}
+} // namespace
+
+TEST(ShmRing, PublishAttachDetachResume) {
+  const std::string name = ring_name("resume");
+  ShmRingWriter<MarketDataEvent> writer;
+  ASSERT_TRUE(writer.create(name, 64));
+  writer.publish(event(0));  // before anyone attached: not seen
+
+  ShmRingReader<MarketDataEvent> reader;
+  ASSERT_FALSE(reader.attach(name, SHM_MAX_CONSUMERS));
+  ASSERT_TRUE(reader.attach(name, 0));
+  ASSERT_TRUE(reader.producer_alive(1'000'000'000));
+  for (int i = 1; i <= 5; ++i) writer.publish(event(i));
+  MarketDataEvent out[8];
+  ASSERT_EQ(reader.read(out, 3), 3u);
+  ASSERT_EQ(out[0].bid, 1001);
+  ASSERT_EQ(out[2].bid, 1003);
+  ASSERT_EQ(writer.lag(0), 2u);
+
+  reader.detach();
+  for (int i = 6; i <= 8; ++i) writer.publish(event(i));
+  ASSERT_TRUE(reader.attach(name, 0));  // resumes at the saved cursor
+  ASSERT_EQ(reader.read(out, 8), 5u);
+  ASSERT_EQ(out[0].bid, 1004);
+  ASSERT_EQ(out[4].bid, 1008);
+  ASSERT_EQ(reader.lost(), 0u);
+  reader.detach();
+  ShmRegion::unlink(name);
+}
+
+TEST(ShmRing, LappedReaderSkipsAheadAndCountsLoss) {
+  const std::string name = ring_name("lap");
+  ShmRingWriter<MarketDataEvent> writer;
+  ASSERT_TRUE(writer.create(name, 16));
+  ShmRingReader<MarketDataEvent> reader;
+  ASSERT_TRUE(reader.attach(name, 1));
+  std::vector<MarketDataEvent> batch;
+  for (int i = 0; i < 40; ++i) batch.push_back(event(i));
+  writer.publish_n(batch.data(), batch.size());
+  MarketDataEvent out[16];
+  const size_t n = reader.read(out, 16);
+  ASSERT_EQ(n + reader.lost(), 40u);
+  ASSERT_EQ(out[n - 1].bid, 1039);
+  for (size_t i = 1; i < n; ++i) ASSERT_EQ(out[i].bid, out[i - 1].bid + 1);
+  reader.detach();
+  ShmRegion::unlink(name);
+}
+
+TEST(ShmRing, GatingReaderHoldsBackTryPublish) {
+  const std::string name = ring_name("gate");
+  ShmRingWriter<MarketDataEvent> writer;
+  ASSERT_TRUE(writer.create(name, 16));
+  ShmRingReader<MarketDataEvent> recorder, monitor;
+  ASSERT_TRUE(recorder.attach(name, 0, true));
+  ASSERT_TRUE(monitor.attach(name, 1));  // lossy: never holds the writer back
+  for (int i = 0; i < 16; ++i) ASSERT_TRUE(writer.try_publish(event(i)));
+  ASSERT_FALSE(writer.try_publish(event(16)));
+  ASSERT_EQ(writer.try_claim(), nullptr);
+
+  MarketDataEvent out[16];
+  ASSERT_EQ(recorder.read(out, 4), 4u);
+  std::vector<MarketDataEvent> batch;
+  for (int i = 16; i < 26; ++i) batch.push_back(event(i));
+  ASSERT_EQ(writer.try_publish_n(batch.data(), batch.size()), 4u);
+
+  // Detached, the recorder still gates, and resumes without a hole.
+  recorder.detach();
+  ASSERT_FALSE(writer.try_publish(event(20)));
+  ASSERT_TRUE(recorder.attach(name, 0, true));
+  ASSERT_EQ(recorder.read(out, 16), 16u);
+  for (int i = 0; i < 16; ++i) ASSERT_EQ(out[i].ts_ns, i + 4);
+  ASSERT_EQ(recorder.lost(), 0u);
+  ASSERT_EQ(writer.try_publish_n(batch.data() + 4, 6), 6u);
+
+  // Re-attached without gating, it no longer holds the writer back.
+  recorder.detach();
+  ASSERT_TRUE(recorder.attach(name, 0));
+  for (int i = 0; i < 32; ++i) ASSERT_TRUE(writer.try_publish(event(26 + i)));
+  ASSERT_GT(monitor.read(out, 16), 0u);
+  ASSERT_GT(monitor.lost(), 0u);  // lapped by the ungated writes
+  recorder.detach();
+  monitor.detach();
+  ShmRegion::unlink(name);
+}
+
+TEST(ShmRing, ExistingRingOfAnotherLayoutIsNotResized) {
+  const std::string name = ring_name("resize");
+  ShmRingWriter<MarketDataEvent> writer;
+  ASSERT_TRUE(writer.create(name, 64));
+  ShmRingReader<MarketDataEvent> reader;
+  ASSERT_TRUE(reader.attach(name, 0));
+  writer.publish(event(1));
+
+  ShmRingWriter<MarketDataEvent> bigger;
+  ASSERT_FALSE(bigger.create(name, 128));
+  ShmRegion region;
+  ASSERT_FALSE(region.create(name, shm_ring_bytes(32, sizeof(MarketDataEvent))));
+  ASSERT_TRUE(region.create(name, shm_ring_bytes(64, sizeof(MarketDataEvent))));
+  region.close();
+
+  // The attached reader is untouched, and a same-layout restart continues.
+  ShmRingWriter<MarketDataEvent> restarted;
+  ASSERT_TRUE(restarted.create(name, 64));
+  restarted.publish(event(2));
+  MarketDataEvent out[4];
+  ASSERT_EQ(reader.read(out, 4), 2u);
+  ASSERT_EQ(out[1].ts_ns, 2);
+  reader.detach();
+  ShmRegion::unlink(name);
+}
+
+TEST(ShmRing, CrossProcessReaderAndCrashRecovery) {
+  const std::string name = ring_name("xproc");
+  ShmRingWriter<MarketDataEvent> writer;
+  ASSERT_TRUE(writer.create(name, 1024));
+  constexpr int kEvents = 500;
+
+  // Child attaches to slot 2, reads the first half and dies without
+  // detaching (simulated crash).
+  int ready[2];
+  ASSERT_EQ(pipe(ready), 0);
+  const pid_t child = fork();
+  if (child == 0) {
+    ShmRingReader<MarketDataEvent> r;
+    char ok = r.attach(name, 2) ? 1 : 0;
+    (void)!write(ready[1], &ok, 1);
+    int64_t expected = 0;
+    MarketDataEvent ev;
+    while (expected < kEvents / 2) {
+      if (!r.try_read(ev)) continue;
+      if (ev.ts_ns != expected++) _exit(2);
+    }
+    _exit(0);
+  }
+  char ok = 0;
+  ASSERT_EQ(read(ready[0], &ok, 1), 1);
+  ASSERT_EQ(ok, 1);
+  for (int i = 0; i < kEvents; ++i) writer.publish(event(i));
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+
+  // The dead child's slot can be taken over and resumes after its last read.
+  ShmRingReader<MarketDataEvent> reader;
+  ASSERT_TRUE(reader.attach(name, 2));
+  MarketDataEvent ev;
+  ASSERT_TRUE(reader.try_read(ev));
+  ASSERT_EQ(ev.ts_ns, kEvents / 2);
+  // Another live process cannot take a slot that is held.
+  const pid_t thief = fork();
+  if (thief == 0) {
+    ShmRingReader<MarketDataEvent> r;
+    _exit(r.attach(name, 2) ? 1 : 0);
+  }
+  ASSERT_EQ(waitpid(thief, &status, 0), thief);
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  reader.detach();
+  close(ready[0]);
+  close(ready[1]);
+  ShmRegion::unlink(name);
+}
@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include "lumina/itch_feed.hpp"
+#include "lumina/market_data_handler.hpp"
+#include "lumina/thread_utils.hpp"
+#include "lumina/udp_feed.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace lumina;
+
+namespace {
+constexpr size_t kPerPacket = 5;
+
+uint16_t test_port(int offset) {
+  return static_cast<uint16_t>(20000 + (getpid() * 7 + offset * 2) % 30000);
+}
+
+UdpFeedOptions loopback_options(int test) {
+  UdpFeedOptions o;
+  o.a = {"239.255.77.1", test_port(test), "127.0.0.1"};
+  o.b = {"239.255.77.2", test_port(test), "127.0.0.1"};
+  o.first_seq = 1;
+  return o;
+}
+
+/// n add records numbered from 1, without the file header, 8-byte aligned.
+struct Records {
+  explicit Records(size_t n) {
+    std::ostringstream out;
+    ItchWriter w(out);
+    for (size_t i = 0; i < n; ++i)
+      w.add_order(static_cast<TimestampNs>(i), i + 1, Side::Buy, 100 + i, 10);
+    const std::string bytes = out.str().substr(sizeof(ItchFileHeader));
+    words.resize(bytes.size() / 8);
+    std::memcpy(words.data(), bytes.data(), bytes.size());
+  }
+  /// Send packet k (records k*kPerPacket + 1 ...) on line.
+  bool send(UdpFeedPublisher& pub, int line, size_t k) const {
+    const char* base = reinterpret_cast<const char*>(words.data());
+    return pub.send(line, k * kPerPacket + 1, kPerPacket,
+                    base + k * kPerPacket * sizeof(ItchAddOrder),
+                    kPerPacket * sizeof(ItchAddOrder));
+  }
+  std::vector<uint64_t> words;
+};
+
+/// Poll until want messages arrived or a second passed.
+std::vector<FeedMessage> collect(UdpFeedSource& feed, size_t want) {
+  std::vector<FeedMessage> got;
+  FeedMessage batch[64];
+  const TimestampNs deadline = monotonic_ns() + 1'000'000'000;
+  while (got.size() < want && monotonic_ns() < deadline) {
+    const size_t n = feed.poll(batch, 64);
+    got.insert(got.end(), batch, batch + n);
+    if (n == 0) std::this_thread::yield();
+  }
+  return got;
+}
+
+/// msgs[from..] are numbered consecutively from first.
+void expect_in_order(const std::vector<FeedMessage>& msgs, uint64_t first, size_t from = 0) {
+  for (size_t i = from; i < msgs.size(); ++i) EXPECT_EQ(msgs[i].seq, first + i - from);
+}
+} // namespace
+
+TEST(UdpFeed, ArbitratesRedundantLines) {
+  UdpFeedSource feed;
+  const UdpFeedOptions options = loopback_options(0);
+  ASSERT_TRUE(feed.open(options));
+  UdpFeedPublisher pub;
+  ASSERT_TRUE(pub.open(options.a, options.b));
+  Records recs(20);
+  for (size_t k = 0; k < 4; ++k) {
+    ASSERT_TRUE(recs.send(pub, 0, k));
+    ASSERT_TRUE(recs.send(pub, 1, k));
+  }
+  const auto msgs = collect(feed, 20);
+  ASSERT_EQ(msgs.size(), 20u);
+  expect_in_order(msgs, 1);
+  EXPECT_EQ(msgs[7].price, 107);
+  FeedMessage extra[8];
+  EXPECT_EQ(feed.poll(extra, 8), 0u);
+  const UdpFeedStats& s = feed.stats();
+  EXPECT_EQ(s.packets[0] + s.packets[1], 8u);
+  EXPECT_EQ(s.first[0] + s.first[1], 4u);
+  EXPECT_EQ(s.duplicates, 4u);
+  EXPECT_EQ(s.gaps, 0u);
+  EXPECT_EQ(feed.next_seq(), 21u);
+}
+
+TEST(UdpFeed, OtherLineFillsGap) {
+  UdpFeedSource feed;
+  const UdpFeedOptions options = loopback_options(1);
+  ASSERT_TRUE(feed.open(options));
+  UdpFeedPublisher pub;
+  ASSERT_TRUE(pub.open(options.a, options.b));
+  Records recs(15);
+  // A loses packet 1; B has everything but is behind.
+  recs.send(pub, 0, 0);
+  recs.send(pub, 0, 2);
+  recs.send(pub, 1, 0);
+  recs.send(pub, 1, 1);
+  recs.send(pub, 1, 2);
+  const auto msgs = collect(feed, 15);
+  ASSERT_EQ(msgs.size(), 15u);
+  expect_in_order(msgs, 1);
+  EXPECT_EQ(feed.stats().gaps, 0u);
+  EXPECT_EQ(feed.stats().reordered, 1u);
+  EXPECT_EQ(feed.stats().first[1], 1u);
+}
+
+TEST(UdpFeed, GivesUpGapAndCountsLatePackets) {
+  UdpFeedSource feed;
+  UdpFeedOptions options = loopback_options(2);
+  options.gap_timeout_ns = 1'000'000;
+  ASSERT_TRUE(feed.open(options));
+  uint64_t gap_from = 0, gap_to = 0;
+  feed.set_recovery_callback([&](uint64_t from, uint64_t to) {
+    gap_from = from;
+    gap_to = to;
+  });
+  UdpFeedPublisher pub;
+  ASSERT_TRUE(pub.open(options.a, options.b));
+  Records recs(15);
+  recs.send(pub, 0, 0);
+  recs.send(pub, 0, 2);
+  auto msgs = collect(feed, 5);
+  ASSERT_EQ(msgs.size(), 5u);
+  // Packet 1 never shows up in time: delivery resumes after the gap.
+  msgs = collect(feed, 5);
+  ASSERT_EQ(msgs.size(), 5u);
+  expect_in_order(msgs, 11);
+  EXPECT_EQ(gap_from, 6u);
+  EXPECT_EQ(gap_to, 11u);
+  EXPECT_EQ(feed.stats().gaps, 1u);
+  EXPECT_EQ(feed.stats().gap_messages, 5u);
+
+  recs.send(pub, 1, 1);
+  FeedMessage batch[8];
+  for (int i = 0; i < 100 && feed.stats().packets[1] == 0; ++i) feed.poll(batch, 8);
+  EXPECT_EQ(feed.poll(batch, 8), 0u);
+  EXPECT_EQ(feed.stats().late, 1u);
+  EXPECT_EQ(feed.stats().duplicates, 0u);
+}
+
+TEST(UdpFeed, FullReorderWindowForcesGap) {
+  UdpFeedSource feed;
+  UdpFeedOptions options = loopback_options(3);
+  options.reorder_window = 2;
+  options.gap_timeout_ns = INT64_MAX;
+  ASSERT_TRUE(feed.open(options));
+  UdpFeedPublisher pub;
+  ASSERT_TRUE(pub.open(options.a));
+  Records recs(25);
+  for (size_t k : {0, 2, 3, 4}) recs.send(pub, 0, k);
+  const auto msgs = collect(feed, 20);
+  ASSERT_EQ(msgs.size(), 20u);
+  for (size_t i = 0; i < 5; ++i) EXPECT_EQ(msgs[i].seq, i + 1);
+  expect_in_order(msgs, 11, 5);
+  EXPECT_EQ(feed.stats().gaps, 1u);
+  EXPECT_EQ(feed.stats().reordered, 2u);
+}
+
+TEST(UdpFeed, RefusesDamagedPackets) {
+  UdpFeedSource feed;
+  UdpFeedOptions options = loopback_options(5);
+  options.gap_timeout_ns = 1'000'000;
+  ASSERT_TRUE(feed.open(options));
+  uint64_t gap_from = 0, gap_to = 0;
+  feed.set_recovery_callback([&](uint64_t from, uint64_t to) {
+    gap_from = from;
+    gap_to = to;
+  });
+  UdpFeedPublisher pub;
+  ASSERT_TRUE(pub.open(options.a, options.b));
+  Records recs(20);
+  const char* base = reinterpret_cast<const char*>(recs.words.data());
+  const size_t rec = sizeof(ItchAddOrder);
+  // A's copy of packet 0 claims five records but carries four; B's is whole.
+  ASSERT_TRUE(pub.send(0, 1, kPerPacket, base, (kPerPacket - 1) * rec));
+  ASSERT_TRUE(recs.send(pub, 1, 0));
+  auto msgs = collect(feed, 5);
+  ASSERT_EQ(msgs.size(), 5u);
+  expect_in_order(msgs, 1);
+  EXPECT_EQ(feed.stats().malformed, 1u);
+
+  // Packet 1 is damaged on the only line that has it: a record cut short.
+  std::vector<uint64_t> bad(recs.words.begin() + kPerPacket * rec / 8,
+                            recs.words.begin() + 2 * kPerPacket * rec / 8);
+  reinterpret_cast<ItchHeader*>(reinterpret_cast<char*>(bad.data()) + 2 * rec)->length =
+      sizeof(ItchHeader);
+  ASSERT_TRUE(pub.send(0, 6, kPerPacket, reinterpret_cast<const char*>(bad.data()),
+                       kPerPacket * rec));
+  ASSERT_TRUE(recs.send(pub, 0, 2));
+  msgs = collect(feed, 5);
+  ASSERT_EQ(msgs.size(), 5u);
+  expect_in_order(msgs, 11);
+  EXPECT_EQ(feed.stats().malformed, 2u);
+  EXPECT_EQ(feed.stats().gaps, 1u);
+  EXPECT_EQ(gap_from, 6u);
+  EXPECT_EQ(gap_to, 11u);
+}
+
+TEST(UdpFeed, ReplayStopsAtRecordsItCannotSend) {
+  std::ostringstream out;
+  ItchWriter w(out);
+  w.add_order(1, 1, Side::Buy, 100, 10);
+  w.add_order(2, 2, Side::Buy, 101, 10);
+  w.add_order(3, 3, Side::Buy, 102, 10);
+  std::string capture = out.str();
+  const size_t second = sizeof(ItchFileHeader) + sizeof(ItchAddOrder);
+  UdpFeedPublisher pub;  // no open lines: replay only cuts packets
+  ASSERT_EQ(pub.replay(capture.data(), capture.size()), 3u);
+
+  // Larger than any packet: used to spin sending empty packets.
+  std::string big = capture.substr(0, second);
+  ItchHeader h{};
+  h.length = static_cast<uint16_t>(FEED_MAX_PAYLOAD + 8);
+  h.type = ItchType::AddOrder;
+  h.seq = 2;
+  big.append(reinterpret_cast<const char*>(&h), sizeof(h));
+  big.resize(second + h.length);
+  EXPECT_EQ(pub.replay(big.data(), big.size()), 1u);
+
+  // Lengths the decoder refuses: unaligned, and short for the type.
+  for (uint16_t length : {static_cast<uint16_t>(sizeof(ItchAddOrder) + 4),
+                          static_cast<uint16_t>(sizeof(ItchHeader))}) {
+    std::string bad = capture;
+    std::memcpy(&bad[second], &length, sizeof(length));
+    EXPECT_EQ(pub.replay(bad.data(), bad.size()), 1u);
+  }
+}
+
+#if !defined(LUMINA_MBP_BOOK)
+TEST(UdpFeed, PacedCaptureReplayDrivesHandler) {
+  constexpr size_t kOrders = 1000;
+  const std::string path = "/tmp/lumina_udp_" + std::to_string(getpid()) + ".bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    ItchWriter w(out);
+    for (size_t i = 0; i < kOrders; ++i) {
+      const Side side = i % 2 ? Side::Sell : Side::Buy;
+      w.add_order(i, i + 1, side, side == Side::Buy ? 1000 - i % 10 : 1001 + i % 10, 10);
+      if (i % 4 == 3) w.delete_order(i, i - 1);
+    }
+  }
+  MappedFile capture;
+  ASSERT_TRUE(capture.open(path));
+  std::remove(path.c_str());
+  ReplayFeedSource direct;
+  ASSERT_TRUE(direct.open_buffer(capture.data(), capture.size()));
+  auto ring = std::make_shared<MarketDataHandler::MDRing>();
+  MarketDataHandler expected(ring);
+  expected.set_feed(&direct);
+  while (!direct.finished()) expected.poll_feed();
+  ring = std::make_shared<MarketDataHandler::MDRing>();
+
+  UdpFeedSource feed;
+  const UdpFeedOptions options = loopback_options(4);
+  ASSERT_TRUE(feed.open(options));
+  MarketDataHandler handler(ring);
+  handler.set_feed(&feed);
+  UdpFeedPublisher pub;
+  ASSERT_TRUE(pub.open(options.a, options.b));
+  uint64_t sent = 0;
+  std::thread publisher([&] {
+    sent = pub.replay(capture.data(), capture.size(), 100'000, 16);  // ~13 ms
+  });
+  const uint64_t total = direct.decoder().decoded();
+  const TimestampNs deadline = monotonic_ns() + 5'000'000'000;
+  while (feed.stats().messages < total && monotonic_ns() < deadline) {
+    if (handler.poll_feed() == 0) std::this_thread::yield();
+  }
+  publisher.join();
+  while (handler.poll_feed()) {}
+
+  EXPECT_EQ(sent, total);
+  EXPECT_EQ(feed.stats().messages, total);
+  EXPECT_EQ(feed.stats().gaps, 0u);
+  EXPECT_EQ(handler.last_seq(), total);
+  EXPECT_EQ(handler.order_book().bid_volume(), expected.order_book().bid_volume());
+  EXPECT_EQ(handler.order_book().ask_volume(), expected.order_book().ask_volume());
+  EXPECT_EQ(handler.order_book().best_bid(), expected.order_book().best_bid());
+  EXPECT_EQ(handler.order_book().best_ask(), expected.order_book().best_ask());
+}
+#endif
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "lumina/simd_indicators.hpp"
+#include "lumina/strategy_engine.hpp"
+#include "lumina/volatility.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace lumina;
+
+namespace {
+/// Random-walk mids around 10000, moving on every step.
+std::vector<Price> walk(size_t n, int max_step, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<Price> mids{10000};
+  while (mids.size() < n) {
+    const Price step = static_cast<Price>(rng() % (2 * max_step + 1)) - max_step;
+    if (step != 0) mids.push_back(mids.back() + step);
+  }
+  return mids;
+}
+
+double log_return(Price from, Price to) {
+  return std::log(static_cast<double>(to) / static_cast<double>(from));
+}
+} // namespace
+
+TEST(Volatility, RollingMatchesBatchVariance) {
+  VolOptions options;
+  options.window = 64;
+  VolatilityEstimator vol(options);
+  const std::vector<Price> mids = walk(5000, 3, 1);
+  std::vector<double> returns;
+  for (size_t i = 0; i < mids.size(); ++i) {
+    vol.update(mids[i], static_cast<TimestampNs>(i));
+    if (i == 0) continue;
+    returns.push_back(log_return(mids[i - 1], mids[i]));
+    const size_t n = std::min<size_t>(returns.size(), 64);
+    const double batch = variance_simd(returns.data() + returns.size() - n, n);
+    ASSERT_NEAR(vol.variance(), batch, 1e-9 * batch + 1e-15) << "at " << i;
+  }
+  EXPECT_EQ(vol.samples(), mids.size() - 1);
+  EXPECT_TRUE(vol.ready());
+  EXPECT_DOUBLE_EQ(vol.mean_dt_ns(), 1.0);  // one move per ns
+  EXPECT_DOUBLE_EQ(vol.variance_per_sec(), vol.variance() * 1e9);
+}
+
+TEST(Volatility, UnchangedMidAddsTimeNotReturns) {
+  VolOptions options;
+  options.min_samples = 2;
+  VolatilityEstimator vol(options);
+  vol.update(10000, 0);
+  vol.update(10000, 500);  // a trade: mid unchanged
+  vol.update(10010, 1000);
+  vol.update(10010, 1500);
+  vol.update(10000, 3000);
+  EXPECT_EQ(vol.samples(), 2u);
+  EXPECT_DOUBLE_EQ(vol.mean_dt_ns(), 1500.0);
+  const double r = std::log(10010.0 / 10000.0);
+  const double mean = (r + std::log(10000.0 / 10010.0)) / 2;
+  EXPECT_NEAR(vol.variance(), r * r - mean * mean, 1e-15);
+  EXPECT_NEAR(vol.variance_per_sec(), vol.variance() * 1e9 / 1500.0, 1e-12);
+  EXPECT_TRUE(vol.ready());
+
+  VolatilityEstimator same_time(options);
+  for (Price mid : {100, 101, 100, 101}) same_time.update(mid, 7);
+  EXPECT_FALSE(same_time.ready());  // no time elapsed: no per-second rate
+}
+
+TEST(Volatility, TimeDecayMatchesWeightedVariance) {
+  VolOptions options;
+  options.model = VolModel::TimeDecay;
+  options.half_life_ns = 1000;
+  VolatilityEstimator vol(options);
+  const std::vector<Price> mids = walk(300, 5, 2);
+  std::vector<double> returns;
+  std::vector<TimestampNs> times;
+  TimestampNs ts = 0;
+  for (size_t i = 0; i < mids.size(); ++i) {
+    ts += static_cast<TimestampNs>(i % 4 == 0 ? 0 : 37 * (i % 11));  // bursts share a timestamp
+    vol.update(mids[i], ts);
+    if (i == 0) continue;
+    returns.push_back(log_return(mids[i - 1], mids[i]));
+    times.push_back(ts);
+  }
+  double w_sum = 0, mean = 0, dt_sum = 0;
+  for (size_t i = 0; i < returns.size(); ++i) {
+    const double w = std::exp2(-static_cast<double>(ts - times[i]) / 1000.0);
+    w_sum += w;
+    mean += w * returns[i];
+    dt_sum += w * static_cast<double>(times[i] - (i ? times[i - 1] : 0));
+  }
+  mean /= w_sum;
+  double var = 0;
+  for (size_t i = 0; i < returns.size(); ++i) {
+    const double w = std::exp2(-static_cast<double>(ts - times[i]) / 1000.0);
+    var += w * (returns[i] - mean) * (returns[i] - mean);
+  }
+  var /= w_sum;
+  EXPECT_NEAR(vol.variance(), var, 1e-9 * var);
+  EXPECT_NEAR(vol.mean(), mean, 1e-12);
+  EXPECT_NEAR(vol.mean_dt_ns(), dt_sum / w_sum, 1e-9 * dt_sum / w_sum);
+}
+
+TEST(Volatility, EwmaFollowsRegimeChange) {
+  VolOptions options;
+  options.model = VolModel::Ewma;
+  options.alpha = 0.1;
+  VolatilityEstimator vol(options);
+  const std::vector<Price> calm = walk(200, 1, 3);
+  for (size_t i = 0; i < calm.size(); ++i) vol.update(calm[i], 0);
+  const double calm_sigma = vol.sigma();
+  EXPECT_GT(calm_sigma, 0.0);
+  std::vector<Price> wild = walk(200, 20, 4);
+  const Price shift = calm.back() - wild.front();
+  for (size_t i = 0; i < wild.size(); ++i) vol.update(wild[i] + shift, 0);
+  EXPECT_GT(vol.sigma(), 5 * calm_sigma);
+  vol.update(0, 0);  // no mid: ignored
+  EXPECT_EQ(vol.samples(), calm.size() + wild.size() - 2);  // the shifted start did not move
+}
+
+TEST(Volatility, StrategySetsSigmaPerEvent) {
+  auto ring = std::make_shared<StrategyEngine::MDRing>();
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine engine(ring, 0.1, 0.02, 1.0, risk);
+  VolOptions options;
+  options.window = 8;
+  options.min_samples = 4;
+  engine.set_vol_options(options);
+  MarketDataEvent ev{};
+  ev.flag = MDFlag::BookUpdate;
+  const Price mids[] = {10000, 10004, 9998, 10002, 10000, 10006};
+  for (size_t i = 0; i < 4; ++i) {
+    ev.bid = mids[i];
+    ev.ts_ns = static_cast<TimestampNs>(i) * 1'000'000;
+    ASSERT_TRUE(ring->try_push(ev));
+  }
+  engine.poll();
+  EXPECT_EQ(engine.sigma(), 0.02);  // three returns: not ready yet
+  for (size_t i = 4; i < 6; ++i) {
+    ev.bid = mids[i];
+    ev.ts_ns = static_cast<TimestampNs>(i) * 1'000'000;
+    ASSERT_TRUE(ring->try_push(ev));
+    engine.poll();
+    EXPECT_DOUBLE_EQ(engine.sigma(),
+                     engine.volatility().sigma_per_sec() * static_cast<double>(mids[i]));
+  }
+  EXPECT_GT(engine.sigma(), 1.0);
+}
+
+TEST(Volatility, QuotesWidenAsVolatilityRises) {
+  auto ring = std::make_shared<StrategyEngine::MDRing>();
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine engine(ring, 0.1, 0.02, 1.0, risk);
+  VolOptions options;
+  options.window = 32;
+  options.min_samples = 8;
+  engine.set_vol_options(options);
+  MarketDataEvent ev{};
+  ev.flag = MDFlag::BookUpdate;
+  TimestampNs ts = 0;
+  auto spread_after = [&](Price step) {
+    for (int i = 0; i < 64; ++i) {
+      ev.bid = 10000 + (i % 2 ? step : 0);
+      ev.ts_ns = ts += 1'000'000;  // a move per ms
+      EXPECT_TRUE(ring->try_push(ev));
+      engine.poll();
+    }
+    return engine.quotes().ask().price - engine.quotes().bid().price;
+  };
+  const Price calm = spread_after(1);
+  const double calm_sigma = engine.sigma();
+  const Price wild = spread_after(8);
+  EXPECT_GT(engine.sigma(), 4 * calm_sigma);
+  EXPECT_GT(calm, 0);
+  EXPECT_GT(wild, 10 * calm);
+}
+
+TEST(Volatility, QuotesWidenOnEpochTimestampsPastTheHorizon) {
+  auto ring = std::make_shared<StrategyEngine::MDRing>();
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine engine(ring, 0.1, 0.02, 3600.0, risk);
+  VolOptions options;
+  options.window = 32;
+  options.min_samples = 8;
+  engine.set_vol_options(options);
+  MarketDataEvent ev{};
+  ev.flag = MDFlag::BookUpdate;
+  TimestampNs ts = 1'760'000'000'000'000'000LL;  // ns since the epoch
+  auto spread_after = [&](Price step) {
+    for (int i = 0; i < 64; ++i) {
+      ev.bid = 10000 + (i % 2 ? step : 0);
+      ev.ts_ns = ts += 1'000'000;
+      EXPECT_TRUE(ring->try_push(ev));
+      engine.poll();
+    }
+    return engine.quotes().ask().price - engine.quotes().bid().price;
+  };
+  const Price calm = spread_after(1);
+  ts += 2 * 3600 * 1'000'000'000LL + 5'000'000'000LL;  // two horizons later
+  const Price wild = spread_after(8);
+  EXPECT_GT(calm, 0);
+  EXPECT_GT(wild, 10 * calm);
+}
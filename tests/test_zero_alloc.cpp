@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "lumina/fix_engine.hpp"
+#include "lumina/order_book.hpp"
+#include "lumina/scratch_arena.hpp"
+#include "lumina/strategy_engine.hpp"
+#include <cstdlib>
+#include <new>
+
+// Global operator new/delete replaced with counting versions. Only calls made
+// by the test thread inside a CountAllocs scope are counted.
+namespace {
+thread_local bool g_counting = false;
+thread_local size_t g_allocs = 0;
+
+void* counted_alloc(size_t n, size_t align) {
+  if (g_counting) ++g_allocs;
+  if (n == 0) n = 1;
+  void* p = align > alignof(std::max_align_t)
+              ? std::aligned_alloc(align, (n + align - 1) / align * align)
+              : std::malloc(n);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+struct CountAllocs {
+  CountAllocs() {
+    g_allocs = 0;
+    g_counting = true;
+  }
+  ~CountAllocs() { g_counting = false; }
+  size_t count() const { return g_allocs; }
+};
+} // namespace
+
+void* operator new(size_t n) { return counted_alloc(n, 0); }
+void* operator new[](size_t n) { return counted_alloc(n, 0); }
+void* operator new(size_t n, std::align_val_t a) { return counted_alloc(n, size_t(a)); }
+void* operator new[](size_t n, std::align_val_t a) { return counted_alloc(n, size_t(a)); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+  try { return counted_alloc(n, 0); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+  try { return counted_alloc(n, 0); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+using namespace lumina;
+
+TEST(ZeroAlloc, CounterSeesHeapFills) {
+  CountAllocs allocs;
+  FillSink fills;  // no arena: grows on the heap
+  fills.push_back(Trade{});
+  EXPECT_EQ(allocs.count(), 1u);
+}
+
+TEST(ZeroAlloc, MatchingSweepIntoScratchArena) {
+  OrderBook book(1 << 12, 1024, 10, 256);
+  ScratchArena scratch(64 << 10);
+  constexpr int kMakers = 200;
+  auto rebuild = [&] {
+    for (int i = 0; i < kMakers; ++i)
+      book.add_order(1000 + i, 10000 + i % 50, 10, Side::Sell);
+  };
+  // Warm-up pass so every pool and the level chunks are already touched.
+  rebuild();
+  {
+    FillSink fills(scratch);
+    book.submit_order(1, 11000, kMakers * 10, Side::Buy, TimeInForce::IOC, false, 0, fills);
+  }
+  scratch.reset();
+  rebuild();
+
+  CountAllocs allocs;
+  FillSink fills(scratch);  // default capacity 64, grows three times in the arena
+  ExecReport rep = book.submit_order(2, 11000, kMakers * 10, Side::Buy, TimeInForce::IOC,
+                                     false, 1, fills);
+  DepthSnapshot<10> depth;
+  book.snapshot_depth(10, depth);
+  scratch.reset();
+  EXPECT_EQ(allocs.count(), 0u);
+  EXPECT_EQ(rep.filled_qty, kMakers * 10);
+  EXPECT_EQ(fills.size(), size_t(kMakers));
+  EXPECT_EQ(scratch.overflow_count(), 0u);
+}
+
+TEST(ZeroAlloc, ScratchArenaAlignsAddresses) {
+  ScratchArena scratch(4096);
+  for (size_t align : {size_t{16}, size_t{64}, size_t{128}, size_t{256}}) {
+    scratch.reset();
+    scratch.allocate(1);
+    auto* p = static_cast<char*>(scratch.allocate(32, align));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % align, 0u) << align;
+    EXPECT_LE(p + 32, static_cast<char*>(scratch.allocate(1, 1)));
+  }
+  struct alignas(64) Line { char bytes[64]; };
+  scratch.reset();
+  scratch.allocate(8);
+  Line* lines = scratch.allocate_array<Line>(3);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(lines) % 64, 0u);
+  EXPECT_EQ(scratch.overflow_count(), 0u);
+}
+
+TEST(ZeroAlloc, FixMessagesIntoScratchArena) {
+  FixEngine fix;
+  ScratchArena scratch(4096);
+  CountAllocs allocs;
+  std::string_view nos = fix.build_new_order_single(scratch, 7, "AAPL", Side::Buy, 100, 15000);
+  std::string_view cxl = fix.build_cancel_request(scratch, 8, 7);
+  EXPECT_EQ(allocs.count(), 0u);
+  EXPECT_EQ(nos, "35=D|11=7|55=AAPL|54=1|40=2|44=15000|38=100|59=1|");
+  EXPECT_EQ(cxl, "35=F|11=8|41=7|");
+}
+
+TEST(ZeroAlloc, StrategyPollPerEvent) {
+  auto ring = std::make_shared<StrategyEngine::MDRing>();
+  PreTradeRisk risk(1'000'000'000'000LL, 1000);
+  StrategyEngine engine(ring, 0.1, 0.02, 1.0, risk);
+  size_t quotes = 0;
+  engine.set_order_callback([&](OrderId, Price, Qty, Side, bool) { ++quotes; });
+
+  constexpr int kEvents = 1000;
+  MarketDataEvent ev{};
+  ev.flag = MDFlag::BookUpdate;
+  ev.bid_volume = 500;
+  ev.ask_volume = 400;
+  CountAllocs allocs;
+  for (int i = 0; i < kEvents; ++i) {
+    ev.bid = 10000 + i % 7;
+    ev.ts_ns = i * 1000;
+    ASSERT_TRUE(ring->try_push(ev));
+    if (i % 16 == 15) engine.poll();
+  }
+  engine.poll();
+  EXPECT_EQ(allocs.count(), 0u);
+  EXPECT_GT(quotes, 0u);
+  EXPECT_EQ(quotes, engine.quotes().stats().news);
+  EXPECT_EQ(engine.scratch().used(), 0u);
+}